@@ -0,0 +1,300 @@
+#ifndef CACHED_MULTICOST_COMPUTE_H
+#define CACHED_MULTICOST_COMPUTE_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "multicost_array.hpp"
+#include "multicost_compute.hpp"
+
+
+struct CostCacheStats {
+    uint64_t numHits = 0;
+    uint64_t numMisses = 0;
+};
+
+
+/***
+    Cost Cache
+    Bounded memo of edge costs keyed by the unique ids of the edge states and the monoid.
+    Every entry carries the version of the edge when it was computed, a lookup with another
+    version misses, so costs are invalidated by bumping versions instead of clearing the cache.
+    Each shard is a table of BUCKET_SIZE way buckets with its own lock, a new entry replaces
+    the stale entry of its key, an empty slot or else a slot picked by the hash of the key.
+    The shard of an entry depends on its first state only, so the edges of a state are looked
+    up and inserted in batches under a single lock.
+    Threads planning on the same map can share a cache, different maps need their own.
+*/
+template<typename T>
+class CostCache {
+public:
+    // capacity is the total number of entries, split between numShards shards
+    CostCache(size_t capacity, unsigned int numShards = 16) : numShards(numShards), shards(new Shard[numShards]) {
+        size_t slotsPerShard = BUCKET_SIZE;
+        while (slotsPerShard * numShards < capacity) slotsPerShard *= 2;
+
+        for (unsigned int i = 0; i < numShards; ++i) shards[i].entries.resize(slotsPerShard);
+    };
+
+
+    bool find(uint32_t frId, uint32_t toId, unsigned int index, uint32_t version, T& value) {
+        Shard& shard = shardOf(frId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return findInShard(shard, frId, toId, index, version, value);
+    };
+
+
+    void insert(uint32_t frId, uint32_t toId, unsigned int index, uint32_t version, const T& value) {
+        Shard& shard = shardOf(frId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        insertInShard(shard, frId, toId, index, version, value);
+    };
+
+
+    // Monoids firstIndex to firstIndex + numIndices of the edges from frId to toIds[0, numEdges), under one lock
+    // values and isFound are indexed by edge * numIndices + monoid - firstIndex
+    void findEdges(uint32_t frId, const uint32_t* toIds, const uint32_t* versions, unsigned int numEdges,
+        unsigned int firstIndex, unsigned int numIndices, T* values, uint8_t* isFound) {
+        Shard& shard = shardOf(frId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        for (unsigned int e = 0; e < numEdges; ++e) {
+            for (unsigned int k = 0; k < numIndices; ++k) {
+                unsigned int slot = e * numIndices + k;
+                isFound[slot] = findInShard(shard, frId, toIds[e], firstIndex + k, versions[e], values[slot]);
+            }
+        }
+    };
+
+
+    // Inserts the values of findEdges that were not found, under one lock
+    void insertEdges(uint32_t frId, const uint32_t* toIds, const uint32_t* versions, unsigned int numEdges,
+        unsigned int firstIndex, unsigned int numIndices, const T* values, const uint8_t* isFound) {
+        Shard& shard = shardOf(frId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        for (unsigned int e = 0; e < numEdges; ++e) {
+            for (unsigned int k = 0; k < numIndices; ++k) {
+                unsigned int slot = e * numIndices + k;
+                if (!isFound[slot]) insertInShard(shard, frId, toIds[e], firstIndex + k, versions[e], values[slot]);
+            }
+        }
+    };
+
+
+    CostCacheStats getStats() {
+        CostCacheStats stats;
+        for (unsigned int i = 0; i < numShards; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            stats.numHits += shards[i].stats.numHits;
+            stats.numMisses += shards[i].stats.numMisses;
+        }
+        return stats;
+    };
+
+private:
+    static constexpr unsigned int BUCKET_SIZE = 4;
+
+    struct Entry {
+        uint32_t frId = 0;
+        uint32_t toId = 0;
+        // Monoid + 1, 0 for an empty slot
+        uint32_t index = 0;
+        uint32_t version = 0;
+        T value = T();
+
+        bool isKey(uint32_t keyFrId, uint32_t keyToId, unsigned int keyIndex) const {
+            return index == keyIndex + 1 && frId == keyFrId && toId == keyToId;
+        };
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+        CostCacheStats stats;
+    };
+
+    unsigned int numShards;
+    std::unique_ptr<Shard[]> shards;
+
+    // Every edge of a state lies in the shard of the state, so a batch of its edges takes one lock
+    Shard& shardOf(uint32_t frId) {
+        uint64_t hash = frId * 0x9E3779B97F4A7C15ull;
+        return shards[(hash >> 32) % numShards];
+    };
+
+    bool findInShard(Shard& shard, uint32_t frId, uint32_t toId, unsigned int index, uint32_t version, T& value) {
+        uint64_t hash = hashKey(frId, toId, index);
+
+        Entry* bucket = &shard.entries[bucketOf(shard, hash)];
+        for (unsigned int i = 0; i < BUCKET_SIZE; ++i) {
+            if (bucket[i].isKey(frId, toId, index) && bucket[i].version == version) {
+                value = bucket[i].value;
+                shard.stats.numHits++;
+                return true;
+            }
+        }
+
+        shard.stats.numMisses++;
+        return false;
+    };
+
+    void insertInShard(Shard& shard, uint32_t frId, uint32_t toId, unsigned int index, uint32_t version, const T& value) {
+        uint64_t hash = hashKey(frId, toId, index);
+
+        Entry* bucket = &shard.entries[bucketOf(shard, hash)];
+        unsigned int slot = (hash >> 16) % BUCKET_SIZE;
+        for (unsigned int i = 0; i < BUCKET_SIZE; ++i) {
+            if (bucket[i].isKey(frId, toId, index)) {
+                slot = i;
+                break;
+            }
+            if (bucket[i].index == 0) slot = i;
+        }
+
+        bucket[slot] = {frId, toId, index + 1, version, value};
+    };
+
+    static size_t bucketOf(const Shard& shard, uint64_t hash) {
+        return hash & (shard.entries.size() - BUCKET_SIZE);
+    };
+
+    static uint64_t hashKey(uint32_t frId, uint32_t toId, unsigned int index) {
+        uint64_t hash = (static_cast<uint64_t>(frId) << 32 | toId) ^ (static_cast<uint64_t>(index) * 0x9E3779B97F4A7C15ull);
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        return hash;
+    };
+};
+
+
+
+/***
+    Cached Multicost Compute
+    Computes the monoids like MonoMulticostCompute, memoized in a CostCache that outlives the
+    graphs using it. edgeVersion gives the version of the inputs of an edge cost, such as the
+    versions of the map regions around its states, which must grow whenever those inputs change.
+    A graph cleared after an edit then only recomputes the edges whose version changed.
+    A batch of edges takes the lock of its shard once for its lookups and once for its misses.
+*/
+template<typename S, typename T, unsigned int SIZE>
+class CachedMulticostCompute : public IMulticostCompute<S> {
+public:
+    CachedMulticostCompute(
+        std::shared_ptr<MonoMulticostArray<T, SIZE>> multicostArray,
+        std::array<std::function<T(S& a, S& b)>, SIZE> computes,
+        std::function<uint32_t(S& a, S& b)> edgeVersion,
+        std::shared_ptr<CostCache<T>> cache
+    ) : multicostArray(multicostArray), computes(computes), edgeVersion(edgeVersion), cache(cache) {};
+
+
+    std::unique_ptr<MulticostID> computeCost(S& a, S& b) override {
+        std::array<T, SIZE> costs;
+        uint32_t version = edgeVersion(a, b);
+        for (unsigned int i = 0; i < SIZE; ++i) costs[i] = cachedCost(a, b, i, version);
+        return multicostArray->make_multicost(std::move(costs));
+    };
+
+
+    std::unique_ptr<MulticostID> computeCost(S& a, S& b, unsigned int index) override {
+        std::array<T, SIZE> costs;
+        costs[index] = cachedCost(a, b, index, edgeVersion(a, b));
+        return multicostArray->make_multicost(std::move(costs));
+    };
+
+
+    void computeCost(S& a, S& b, const std::unique_ptr<MulticostID>& dest, unsigned int index) override {
+        std::array<T, SIZE> costs;
+        costs[index] = cachedCost(a, b, index, edgeVersion(a, b));
+        multicostArray->copy(dest, costs, index);
+    };
+
+
+    void computeCosts(S& a, S* bs, unsigned int numStates, std::unique_ptr<MulticostID>* dests) override {
+        cachedCosts(a, bs, numStates, 0, SIZE);
+
+        for (unsigned int i = 0; i < numStates; ++i) {
+            std::array<T, SIZE> costs;
+            for (unsigned int k = 0; k < SIZE; ++k) costs[k] = batchValues[i * SIZE + k];
+            dests[i] = multicostArray->make_multicost(std::move(costs));
+        }
+    };
+
+
+    void computeCosts(S& a, S* bs, unsigned int numStates, std::unique_ptr<MulticostID>* dests, unsigned int index) override {
+        cachedCosts(a, bs, numStates, index, 1);
+
+        for (unsigned int i = 0; i < numStates; ++i) {
+            std::array<T, SIZE> costs;
+            costs[index] = batchValues[i];
+
+            if (dests[i]) {
+                multicostArray->copy(dests[i], costs, index);
+            } else {
+                dests[i] = multicostArray->make_multicost(std::move(costs));
+            }
+        }
+    };
+
+private:
+    std::shared_ptr<MonoMulticostArray<T, SIZE>> multicostArray;
+    std::array<std::function<T(S& a, S& b)>, SIZE> computes;
+    std::function<uint32_t(S& a, S& b)> edgeVersion;
+    std::shared_ptr<CostCache<T>> cache;
+
+    // Keys and costs of the batch being computed
+    std::vector<uint32_t> batchToIds;
+    std::vector<uint32_t> batchVersions;
+    std::vector<T> batchValues;
+    std::vector<uint8_t> batchIsFound;
+
+    // Fills batchValues with the monoids firstIndex to firstIndex + numIndices of the edges from a to bs
+    void cachedCosts(S& a, S* bs, unsigned int numStates, unsigned int firstIndex, unsigned int numIndices) {
+        uint32_t frId = a.getUniqueId();
+
+        batchToIds.resize(numStates);
+        batchVersions.resize(numStates);
+        batchValues.resize(numStates * numIndices);
+        batchIsFound.resize(numStates * numIndices);
+
+        for (unsigned int i = 0; i < numStates; ++i) {
+            batchToIds[i] = bs[i].getUniqueId();
+            batchVersions[i] = edgeVersion(a, bs[i]);
+        }
+
+        cache->findEdges(frId, batchToIds.data(), batchVersions.data(), numStates, firstIndex, numIndices, batchValues.data(), batchIsFound.data());
+
+        bool hasMisses = false;
+        for (unsigned int i = 0; i < numStates; ++i) {
+            for (unsigned int k = 0; k < numIndices; ++k) {
+                unsigned int slot = i * numIndices + k;
+                if (batchIsFound[slot]) continue;
+
+                batchValues[slot] = computes[firstIndex + k](a, bs[i]);
+                hasMisses = true;
+            }
+        }
+
+        if (hasMisses) {
+            cache->insertEdges(frId, batchToIds.data(), batchVersions.data(), numStates, firstIndex, numIndices, batchValues.data(), batchIsFound.data());
+        }
+    };
+
+    T cachedCost(S& a, S& b, unsigned int index, uint32_t version) {
+        uint32_t frId = a.getUniqueId();
+        uint32_t toId = b.getUniqueId();
+
+        T cost;
+        if (cache->find(frId, toId, index, version, cost)) return cost;
+
+        cost = computes[index](a, b);
+        cache->insert(frId, toId, index, version, cost);
+        return cost;
+    };
+};
+
+#endif
\ No newline at end of file
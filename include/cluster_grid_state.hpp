@@ -0,0 +1,26 @@
+#ifndef CLUSTER_GRID_STATE_H
+#define CLUSTER_GRID_STATE_H
+
+#include <cstdint>
+#include <vector>
+#include "grid_state.hpp"
+
+// Grid cell whose moves stay inside its square cluster of clusterSize cells per side
+class ClusterGridState {
+public:
+    GridState cell;
+    int clusterSize;
+
+    static constexpr unsigned int MAX_NEXT_STATES = GridState::MAX_NEXT_STATES;
+
+    ClusterGridState();
+    ClusterGridState(GridState cell, int clusterSize);
+    uint32_t getUniqueId();
+    std::vector<ClusterGridState> getNextStates();
+    unsigned int getNextStates(ClusterGridState* nextStates);
+
+    uint32_t getClusterId();
+};
+
+
+#endif
\ No newline at end of file
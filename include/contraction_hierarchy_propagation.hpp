@@ -0,0 +1,169 @@
+#ifndef CONTRACTION_HIERARCHY_PROPAGATION_H
+#define CONTRACTION_HIERARCHY_PROPAGATION_H
+
+#include "flat_map.hpp"
+#include "heap.hpp"
+#include "iterated_dijkstra_propagation.hpp"
+#include "multicost_array.hpp"
+#include "multicost_graph.hpp"
+#include "multicost_pathfind.hpp"
+#include "query_cancellation.hpp"
+#include "visited_set.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+struct ContractionHierarchyStats {
+    unsigned int numNodes = 0;
+    unsigned int numEdges = 0;
+    unsigned int numShortcuts = 0;
+    double exploreMilliseconds = 0;
+    double contractMilliseconds = 0;
+};
+
+
+/***
+    Contraction Hierarchy Propagation
+    Preprocesses a contraction hierarchy on the first monoid of a static graph.
+    A query finds the optimal subgraph of the first monoid with two upward searches
+    and unpacks it, then runs the IDP iterations of the remaining monoids inside it.
+    Shortcuts are only skipped for strictly cheaper witnesses and equal cost shortcuts
+    are merged, so every optimal path of the first monoid survives the contraction.
+    Edges only tight through a zero cost cycle of the first monoid are not part of a path and left out.
+    Queries on another graph or on nodes outside the hierarchy fall back to plain IDP.
+*/
+class ContractionHierarchyPropagation : public IteratedDijkstraPropagation, public IMulticostPreprocess {
+public:
+    using IteratedDijkstraPropagation::getOptimalPath;
+
+    void preprocess(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, const std::vector<uint32_t>& seeds) override;
+
+    // Always goes through the hierarchy, even for lexicographic multicosts
+    void getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, std::vector<uint32_t>& path, QueryWorkspace& workspace, QueryCancellation& cancellation, QueryProgress& progress) override;
+
+    const ContractionHierarchyStats& getStats() const {
+        return stats;
+    };
+
+protected:
+    OptimalSubgraph& optimalSubgraph(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryWorkspace& workspace, QueryCancellation& cancellation, QueryProgress& progress) override;
+
+private:
+    struct HierarchyArc {
+        uint32_t frNode;
+        uint32_t toNode;
+        std::unique_ptr<MulticostID> cost;
+        // Original graph edges between the two nodes with this cost
+        std::vector<MulticostEdge> edges;
+        // Pairs of arcs skipped by this shortcut, every pair has this cost
+        std::vector<std::pair<uint32_t, uint32_t>> shortcuts;
+    };
+
+    // Orders a heap of hierarchy weights on the first monoid
+    struct FirstMonoidOrder {
+        IMulticostArray* multicostArray = nullptr;
+
+        bool operator()(const std::unique_ptr<MulticostID>& a, const std::unique_ptr<MulticostID>& b) const {
+            return !(multicostArray->compare(a, b, 0) < 0);
+        };
+    };
+
+    // Weights settled by one search, indexed by hierarchy node
+    // clear() only bumps the epoch, stale weights are overwritten by the next searches
+    struct HierarchyWeights {
+        std::vector<std::unique_ptr<MulticostID>> weights;
+        VisitedSet settled;
+        std::vector<uint32_t> settledNodes;
+
+        void clear(uint32_t numNodes) {
+            if (weights.size() < numNodes) weights.resize(numNodes);
+            settled.clear();
+            settledNodes.clear();
+        };
+
+        bool contains(uint32_t node) const {
+            return settled.contains(node);
+        };
+
+        const std::unique_ptr<MulticostID>& get(uint32_t node) const {
+            return weights[node];
+        };
+
+        void set(uint32_t node, std::unique_ptr<MulticostID> weight) {
+            weights[node] = std::move(weight);
+            settled.insert(node);
+            settledNodes.push_back(node);
+        };
+    };
+
+    // Scratch buffers of a search over the hierarchy, kept between searches
+    struct HierarchySearch {
+        Heap<std::unique_ptr<MulticostID>, FirstMonoidOrder> heap;
+        HierarchyWeights forwardWeights;
+        HierarchyWeights backwardWeights;
+
+        // Arcs and original edges already unpacked, and nodes already walked down
+        VisitedSet unpackedArcs;
+        VisitedSet addedEdges;
+        VisitedSet marked;
+
+        std::vector<uint32_t> meetingNodes;
+        std::vector<uint32_t> stack;
+        std::vector<uint32_t> arcStack;
+
+        HierarchySearch() : heap(FirstMonoidOrder()) {};
+    };
+
+    // Witness searches give up after settling this many nodes and keep the shortcut
+    static constexpr unsigned int WITNESS_SETTLE_LIMIT = 128;
+
+    IMulticostGraph* hierarchyGraph = nullptr;
+    std::shared_ptr<IMulticostArray> hierarchyArray;
+
+    // Nodes of the hierarchy are dense indices into the arrays below
+    FlatMap<uint32_t> nodeToIndex;
+    std::vector<uint32_t> indexToNode;
+    std::vector<unsigned int> ranks;
+
+    std::vector<HierarchyArc> arcs;
+    std::vector<std::vector<uint32_t>> outArcs;
+    std::vector<std::vector<uint32_t>> inArcs;
+
+    std::vector<bool> contracted;
+
+    ContractionHierarchyStats stats;
+
+    // Witness searches of the contraction, queries use a search per thread instead
+    HierarchySearch witness;
+
+    void explore(IMulticostGraph& graph, const std::vector<uint32_t>& seeds);
+    void contract();
+
+    uint32_t addNode(uint32_t nodeId);
+
+    // Merges with the live arc between the nodes when there is one
+    void addArc(uint32_t frNode, uint32_t toNode, std::unique_ptr<MulticostID> cost, const MulticostEdge* edge, const std::pair<uint32_t, uint32_t>* shortcut);
+
+    // Returns the number of shortcuts needed to contract node, only adds them when not simulating
+    unsigned int contractNode(uint32_t node, bool simulate);
+    int contractionPriority(uint32_t node, const std::vector<int>& numContractedNeighbors);
+
+    // Settles witness.forwardWeights from source without going through excluded
+    void witnessSearch(uint32_t source, uint32_t excluded, const std::unique_ptr<MulticostID>& maxCost);
+
+    // Returns false when cancelled
+    bool upwardSearch(uint32_t source, bool isForward, HierarchySearch& search, HierarchyWeights& weights, QueryCancellation& cancellation);
+
+    void addUnpackedEdges(uint32_t arcId, HierarchySearch& search, OptimalSubgraph& optimalSubgraph);
+
+    // Query buffers of the calling thread
+    static HierarchySearch& threadSearch();
+
+    // Bfs over the seeded optimal subgraph so paths can be extracted without an IDP iteration
+    void recordPredecessors(OptimalSubgraph& optimalSubgraph, uint32_t start, QueryWorkspace& workspace);
+};
+
+#endif
\ No newline at end of file
@@ -1,14 +1,42 @@
 #ifndef EXAMPLE_SETUP_H
 #define EXAMPLE_SETUP_H
 
+#include "grid_map.hpp"
 #include "grid_state.hpp"
 #include "iterated_dijkstra_propagation.hpp"
 #include "single_optimal_path_finder.hpp"
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+struct EngineBenchmark {
+    unsigned int numQueries = 0;
+    // Queries whose paths have different multicosts, should stay 0
+    unsigned int numMismatches = 0;
+    double idpMilliseconds = 0;
+    double engineMilliseconds = 0;
+};
+
+struct LayoutBenchmark {
+    GridLayout layout;
+    // Expanding every free cell of a fresh graph
+    double exploreMilliseconds = 0;
+    // Queries on the explored graph
+    double queryMilliseconds = 0;
+    // Hardware counters of the queries, only read where perf events are available (Linux)
+    bool hasCounters = false;
+    uint64_t cacheMisses = 0;
+    uint64_t dtlbMisses = 0;
+};
+
 class ExampleSetup {
 public:
-    ExampleSetup(int gridWidth, int gridHeight);
+    ExampleSetup(int gridWidth, int gridHeight, GridLayout layout = GridLayout::ROW_MAJOR);
+    // Plans on a map that other setups may share, obstacles must not change while any of them plans
+    ExampleSetup(std::shared_ptr<GridMap> gridMap);
+
+    std::shared_ptr<GridMap> getMap();
+    GridState getCell(int x, int y);
 
     std::vector<GridState> getOptimalPath(GridState start, GridState end);
     std::vector<GridState> getOptimalEdges(GridState start, GridState end);
@@ -22,7 +50,17 @@ public:
     // If there any update in the graph, clear everything
     void resetGraph();
 
+    // Times IteratedDijkstraPropagation against IdpEngine on random queries over the current map
+    // Both iterate the monoids on a fully explored graph, reusing their buffers between queries
+    EngineBenchmark benchmarkEngine(unsigned int numQueries, unsigned int seed);
+
+    // Times IteratedDijkstraPropagation on copies of the map in every layout, with node ids in layout order
+    // The same random queries run on every layout, counting their cache and dTLB misses when possible
+    std::vector<LayoutBenchmark> benchmarkLayouts(unsigned int numQueries, unsigned int seed);
+
 private:
+    std::shared_ptr<GridMap> gridMap;
+
     SingleOptimalPathFinder<GridState> singleOptimalPathFinder;
     IteratedDijkstraPropagation idpAlgorithm;
 
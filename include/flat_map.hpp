@@ -0,0 +1,158 @@
+#ifndef FLAT_MAP_H
+#define FLAT_MAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+/***
+    Flat Map
+    Open addressing map from uint32_t ids to V for sparse id spaces, with linear probing
+    over power of two capacities. Keys, values and slot stamps live in flat arrays, so a
+    lookup touches a few contiguous slots instead of chasing the nodes of std::unordered_map.
+    clear() only bumps the epoch like VisitedSet, the capacity is kept for the next fill.
+    Unlike std::unordered_map, references to values are invalidated by inserting a new key.
+*/
+template<typename V>
+class FlatMap {
+public:
+    FlatMap() : epoch(1), numEntries(0) {};
+
+
+    bool contains(uint32_t key) const {
+        return findSlot(key) != NO_SLOT;
+    };
+
+    // Null when the key is missing
+    V* find(uint32_t key) {
+        size_t slot = findSlot(key);
+        return slot == NO_SLOT ? nullptr : &values[slot];
+    };
+
+    const V* find(uint32_t key) const {
+        size_t slot = findSlot(key);
+        return slot == NO_SLOT ? nullptr : &values[slot];
+    };
+
+    V& at(uint32_t key) {
+        V* value = find(key);
+        if (value == nullptr) throw std::out_of_range("FlatMap::at");
+        return *value;
+    };
+
+    const V& at(uint32_t key) const {
+        const V* value = find(key);
+        if (value == nullptr) throw std::out_of_range("FlatMap::at");
+        return *value;
+    };
+
+    // Inserts a default value when the key is missing
+    V& operator[](uint32_t key) {
+        return values[insertSlot(key)];
+    };
+
+    size_t size() const {
+        return numEntries;
+    };
+
+    // O(1) except once every 2^32 clears when the epoch wraps around
+    void clear() {
+        numEntries = 0;
+        epoch += 1;
+        if (epoch == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            epoch = 1;
+        }
+    };
+
+    // Makes room for numKeys keys without rehashing
+    void reserve(size_t numKeys) {
+        size_t capacity = MIN_CAPACITY;
+        while (capacity * MAX_LOAD_NUMERATOR < numKeys * MAX_LOAD_DENOMINATOR) capacity *= 2;
+        if (capacity > keys.size()) rehash(capacity);
+    };
+
+protected:
+    // Protected so tests can start the epoch close to its wrap around
+    uint32_t epoch;
+
+private:
+    static constexpr size_t NO_SLOT = ~static_cast<size_t>(0);
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    // Grows once more than 3/4 of the slots are used
+    static constexpr size_t MAX_LOAD_NUMERATOR = 3;
+    static constexpr size_t MAX_LOAD_DENOMINATOR = 4;
+
+    std::vector<uint32_t> keys;
+    std::vector<V> values;
+    // A slot is used when its stamp is the current epoch
+    std::vector<uint32_t> stamps;
+
+    size_t numEntries;
+
+
+    // Fibonacci hashing spreads structured ids such as x + y * width over the table
+    size_t slotOf(uint32_t key) const {
+        return ((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 32) & (keys.size() - 1);
+    };
+
+    size_t findSlot(uint32_t key) const {
+        if (keys.size() == 0) return NO_SLOT;
+
+        for (size_t slot = slotOf(key); stamps[slot] == epoch; slot = (slot + 1) & (keys.size() - 1)) {
+            if (keys[slot] == key) return slot;
+        }
+        return NO_SLOT;
+    };
+
+    size_t insertSlot(uint32_t key) {
+        if ((numEntries + 1) * MAX_LOAD_DENOMINATOR > keys.size() * MAX_LOAD_NUMERATOR) {
+            rehash(std::max(MIN_CAPACITY, keys.size() * 2));
+        }
+
+        size_t slot = slotOf(key);
+        for (; stamps[slot] == epoch; slot = (slot + 1) & (keys.size() - 1)) {
+            if (keys[slot] == key) return slot;
+        }
+
+        // Stale slots still hold the value of a cleared key
+        keys[slot] = key;
+        values[slot] = V();
+        stamps[slot] = epoch;
+        numEntries++;
+
+        return slot;
+    };
+
+    void rehash(size_t capacity) {
+        std::vector<uint32_t> oldKeys(capacity);
+        std::vector<V> oldValues(capacity);
+        std::vector<uint32_t> oldStamps(capacity, 0);
+
+        keys.swap(oldKeys);
+        values.swap(oldValues);
+        stamps.swap(oldStamps);
+
+        uint32_t oldEpoch = epoch;
+        epoch = 1;
+        numEntries = 0;
+
+        for (size_t i = 0; i < oldKeys.size(); ++i) {
+            if (oldStamps[i] != oldEpoch) continue;
+
+            size_t slot = slotOf(oldKeys[i]);
+            while (stamps[slot] == epoch) slot = (slot + 1) & (keys.size() - 1);
+
+            keys[slot] = oldKeys[i];
+            values[slot] = std::move(oldValues[i]);
+            stamps[slot] = epoch;
+            numEntries++;
+        }
+    };
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+#ifndef GRID_MAP_H
+#define GRID_MAP_H
+
+#include <cstdint>
+#include <vector>
+
+// Order of the cells of a GridMap and of their unique ids
+enum class GridLayout {
+    ROW_MAJOR,
+    // Interleaved bits of x and y inside each curve tile
+    Z_ORDER,
+    // Hilbert curve inside each curve tile
+    HILBERT
+};
+
+
+/***
+    Grid Map
+    Obstacles of one grid, stored in its cell layout. Grid states point to the map they
+    belong to, so a process can hold many maps and plan on each of them. Planning only
+    reads the map, planners on different threads can share it while nobody edits it.
+    Occupancy takes one bit per cell, and every cell also keeps the number of obstacles
+    among its four neighbors so cost functions read it with a single lookup.
+    Cells carry a terrain weight for states that price moves by terrain, 1 by default.
+    Square regions of REGION_SIDE cells keep a version that grows with every edit that can
+    change a cost around their cells, which lets cost caches keep the costs of other regions.
+*/
+class GridMap {
+public:
+    static constexpr int REGION_SIDE = 32;
+
+    GridMap(int width, int height, GridLayout layout = GridLayout::ROW_MAJOR);
+
+    int getWidth() const {
+        return width;
+    };
+
+    int getHeight() const {
+        return height;
+    };
+
+    GridLayout getLayout() const {
+        return layout;
+    };
+
+    // Size of the layout, curves pad the grid to whole tiles
+    uint32_t numCells() const {
+        return cells.size();
+    };
+
+    // Padding cells of the curves are obstacles
+    bool isObstacleAt(uint32_t index) const {
+        return cells[index];
+    };
+
+    bool isObstacle(int x, int y) const {
+        return cells[cellIndex(x, y)];
+    };
+
+    // Obstacles among the four neighbors inside the grid of the cell at index
+    int getObstacleCount(uint32_t index) const {
+        return obstacleCounts[index];
+    };
+
+    float getTerrainWeight(uint32_t index) const {
+        return terrainWeights[index];
+    };
+
+    void setTerrainWeight(int x, int y, float weight);
+
+    uint32_t getRegionVersion(int x, int y) const {
+        return regionVersions[(y / REGION_SIDE) * numRegionsX + x / REGION_SIDE];
+    };
+
+    // Patches the counts of the neighbors
+    void setObstacle(int x, int y, bool isObstacle);
+    // Replaces every cell from row major obstacles and recounts them in one sweep
+    void setObstacles(const std::vector<bool>& obstacles);
+
+    // Position of cell (x, y) in the layout, also the unique id of its GridState
+    uint32_t cellIndex(int x, int y) const;
+    // Inverse of cellIndex
+    void cellCoordinates(uint32_t index, int& x, int& y) const;
+
+    // Unique ids from before no longer match their cells
+    void setLayout(GridLayout layout);
+
+private:
+    int width;
+    int height;
+    GridLayout layout;
+
+    // Curve layouts cover the grid with square tiles in row major order, each tile ordered
+    // by its own curve, so padding stays within the last row and column of tiles
+    static constexpr uint32_t MAX_TILE_SIDE = 256;
+    uint32_t tileSide;
+    uint32_t tileBits;
+    uint32_t numTilesX;
+
+    std::vector<bool> cells; // true -> obstacle, false -> no obstacle
+    std::vector<uint8_t> obstacleCounts;
+    std::vector<float> terrainWeights;
+
+    int numRegionsX;
+    std::vector<uint32_t> regionVersions;
+
+    void countObstacles();
+    void touchRegion(int x, int y);
+};
+
+
+#endif
\ No newline at end of file
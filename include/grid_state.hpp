@@ -3,24 +3,32 @@
 
 #include <cstdint>
 #include <vector>
+#include "grid_map.hpp"
 
+// Cell of a GridMap, the map must outlive its states
 class GridState {
 public:
-    static int GRID_WIDTH;
-    static int GRID_HEIGHT;
-    static std::vector<bool> CELL_STATES; // true -> obstacle, false -> no obstacle
-    
     int x;
     int y;
 
+    static constexpr unsigned int MAX_NEXT_STATES = 4;
+
     GridState();
-    GridState(int x, int y);
+    GridState(const GridMap& map, int x, int y);
     uint32_t getUniqueId();
     std::vector<GridState> getNextStates();
+    // Writes at most MAX_NEXT_STATES states and returns how many, without allocating
+    unsigned int getNextStates(GridState* nextStates);
 
     int numberOfNearbyObstacles();
 
+    const GridMap* getMap() const;
+
+    // Cell at a position of the layout of map, the inverse of getUniqueId
+    static GridState cellAt(const GridMap& map, uint32_t index);
+
 private:
+    const GridMap* map;
     uint32_t linearPos;
     
 };
@@ -1,14 +1,16 @@
 #ifndef HEAP_H
 #define HEAP_H
 
+#include <algorithm>
 #include <functional>
-#include <unordered_map>
 #include <vector>
+#include "visited_set.hpp"
 
-template<typename T>
+// Compare can be any functor, such as an ordering struct that is inlined instead of a std::function
+template<typename T, typename Compare = std::function<bool(const T&, const T&)>>
 class Heap {
 public:
-    Heap(std::function<bool(const T&, const T&)> compare);
+    Heap(Compare compare);
 
     bool push(T item, int unique_id);
 
@@ -25,19 +27,33 @@ public:
         return size;
     }
 
+    // Empties the heap keeping its capacity, the items left are released in O(size)
+    void clear() {
+        for (unsigned int i = 0; i < this->size; ++i) this->heap[i] = T();
+        this->size = 0;
+        this->inHeap.clear();
+    }
+
+    // Only valid while the heap is empty
+    void set_compare(Compare compare) {
+        this->compare = compare;
+    }
+
     ~Heap();
 
 private:
     std::vector<T> heap;
     
     std::vector<int> hid2id;
-    std::unordered_map<int, unsigned int> id2hid; 
+    // Position of each unique id in the heap, ids are assumed dense as in VisitedSet
+    std::vector<unsigned int> id2hid;
+    VisitedSet inHeap;
 
     unsigned int size;
 
     // compare: a is before b in the heap
     // return true if swap a and b, return false if no swap
-    std::function<bool(const T& a, const T& b)> compare;
+    Compare compare;
 
     void swap(unsigned int hida, unsigned int hidb);
 
@@ -46,16 +62,15 @@ private:
 };
 
 
-template<typename T>
-Heap<T>::Heap(std::function<bool(const T&, const T&)> compare) {
+template<typename T, typename Compare>
+Heap<T, Compare>::Heap(Compare compare) : compare(compare) {
     this->size = 0;
-    this->compare = compare;
 }
 
 
-template<typename T>
-bool Heap<T>::push(T item, int unique_id) {
-    if (this->id2hid.find(unique_id) != this->id2hid.end()) {
+template<typename T, typename Compare>
+bool Heap<T, Compare>::push(T item, int unique_id) {
+    if (this->inHeap.contains(unique_id)) {
         //std::cout << "heap push unique id exists! " << unique_id << std::endl;
         //std::cout << "heap push id2hid! " << this->id2hid[unique_id] << std::endl;
         //std::cout << "heap push size! " << this->size << std::endl;
@@ -79,7 +94,9 @@ bool Heap<T>::push(T item, int unique_id) {
         this->hid2id.push_back(unique_id);
     }
 
+    if (static_cast<unsigned int>(unique_id) >= this->id2hid.size()) this->id2hid.resize(std::max<size_t>(this->id2hid.size() * 2, static_cast<size_t>(unique_id) + 1));
     this->id2hid[unique_id] = size;
+    this->inHeap.insert(unique_id);
 
     unsigned int cindex = this->size;
     unsigned int pindex = (cindex - 1) / 2;
@@ -94,14 +111,14 @@ bool Heap<T>::push(T item, int unique_id) {
     return true;
 }
 
-template<typename T>
-void Heap<T>::pop() {
+template<typename T, typename Compare>
+void Heap<T, Compare>::pop() {
     if (this->size == 0) return;
 
     //std::cout << "pop id2hid " << this->hid2id[0] << std::endl;
 
 
-    this->id2hid.erase(this->hid2id[0]);
+    this->inHeap.erase(this->hid2id[0]);
     this->heap[0] = std::move(this->heap[this->size - 1]);
     this->hid2id[0] = this->hid2id[this->size - 1];
     this->id2hid[this->hid2id[this->size - 1]] = 0;
@@ -130,18 +147,18 @@ void Heap<T>::pop() {
     }
 }
 
-template<typename T>
-T Heap<T>::top_item() {
+template<typename T, typename Compare>
+T Heap<T, Compare>::top_item() {
     return std::move(this->heap[0]);
 }
 
-template<typename T>
-int Heap<T>::top_item_id() {
+template<typename T, typename Compare>
+int Heap<T, Compare>::top_item_id() {
     return this->hid2id[0];
 }
 
-template<typename T>
-void Heap<T>::up(int unique_id) {
+template<typename T, typename Compare>
+void Heap<T, Compare>::up(int unique_id) {
     unsigned int cindex = id2hid[unique_id];
     unsigned int pindex = (cindex - 1) / 2;
     while (cindex != 0 && this->compare(this->heap[pindex], this->heap[cindex])) {
@@ -151,8 +168,8 @@ void Heap<T>::up(int unique_id) {
     }
 }
 
-template<typename T>
-void Heap<T>::swap(unsigned int hida, unsigned int hidb) {
+template<typename T, typename Compare>
+void Heap<T, Compare>::swap(unsigned int hida, unsigned int hidb) {
     T a = std::move(this->heap[hida]);
     this->heap[hida] = std::move(this->heap[hidb]);
     this->heap[hidb] = std::move(a);
@@ -165,8 +182,8 @@ void Heap<T>::swap(unsigned int hida, unsigned int hidb) {
     this->id2hid[this->hid2id[hida]] = hida;
 }
 
-template<typename T>
-Heap<T>::~Heap() {
+template<typename T, typename Compare>
+Heap<T, Compare>::~Heap() {
     this->heap.clear();
 }
 
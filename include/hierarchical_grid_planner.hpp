@@ -0,0 +1,294 @@
+#ifndef HIERARCHICAL_GRID_PLANNER_H
+#define HIERARCHICAL_GRID_PLANNER_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "cluster_grid_state.hpp"
+#include "flat_map.hpp"
+#include "grid_map.hpp"
+#include "grid_state.hpp"
+#include "iterated_dijkstra_propagation.hpp"
+#include "multicost.hpp"
+#include "multicost_array.hpp"
+#include "multicost_compute.hpp"
+#include "multicost_graph.hpp"
+
+
+struct HierarchicalGridStats {
+    unsigned int numClusters = 0;
+    unsigned int numEntrances = 0;
+    unsigned int numAbstractEdges = 0;
+    double preprocessMilliseconds = 0;
+};
+
+
+/***
+    Hierarchical Grid Planner
+    Splits a GridMap into square clusters and places entrances on the free runs
+    of every border between two clusters. Preprocessing runs IDP inside each cluster between
+    every ordered pair of its entrances, so the cluster paths share the tie-breaking of flat IDP.
+    The abstract graph holds the multicosts of the resulting paths with the paths themselves.
+    A query connects its endpoints to the entrances of their clusters with IDP as well,
+    runs IDP on the abstract graph and refines the abstract path with the stored paths.
+    The cluster graph is cleared before the searches of each cluster and only holds its cells,
+    which the searches of that cluster then share.
+    Entrances are the dense nodes 0..n-1 of the abstract graph, a query numbers its endpoints after them.
+    Paths must cross clusters through entrances, so they are near optimal instead of optimal.
+    preprocess must run again after the map changes.
+*/
+template<typename T, unsigned int SIZE>
+class HierarchicalGridPlanner {
+public:
+    HierarchicalGridPlanner(std::shared_ptr<const GridMap> gridMap,
+        std::array<T, SIZE> identity,
+        std::array<std::function<int(T a, T b)>, SIZE> compares,
+        std::array<std::function<T(T a, T b)>, SIZE> ops,
+        std::array<std::function<T(GridState& a, GridState& b)>, SIZE> computes,
+        int clusterSize,
+        bool isLexicographic = false
+    ) : gridMap(gridMap), clusterSize(clusterSize) {
+
+        MonoMulticostProps<T, SIZE> props(identity, compares, ops, isLexicographic);
+        multicostArray = std::make_shared<MonoMulticostArray<T, SIZE>>(props);
+        gridCompute = std::make_shared<MonoMulticostCompute<GridState, T, SIZE>>(multicostArray, computes);
+
+        std::array<std::function<T(ClusterGridState& a, ClusterGridState& b)>, SIZE> clusterComputes;
+        for (unsigned int i = 0; i < SIZE; ++i) {
+            std::function<T(GridState& a, GridState& b)> compute = computes[i];
+            clusterComputes[i] = [compute](ClusterGridState& a, ClusterGridState& b) { return compute(a.cell, b.cell); };
+        }
+
+        std::shared_ptr<IMulticostCompute<ClusterGridState>> clusterCompute = std::make_shared<MonoMulticostCompute<ClusterGridState, T, SIZE>>(multicostArray, clusterComputes);
+        clusterGraph = std::make_unique<LazyMulticostGraph<ClusterGridState>>(multicostArray, clusterCompute);
+    };
+
+
+    // Builds the abstract graph of the current map
+    void preprocess() {
+        auto startTime = std::chrono::steady_clock::now();
+
+        clusterGraph->clear();
+        abstractGraph.clear();
+        abstractPaths.clear();
+        entranceNodes.clear();
+        abstractCells.clear();
+        stats = HierarchicalGridStats();
+
+        int numClustersX = (gridMap->getWidth() + clusterSize - 1) / clusterSize;
+        int numClustersY = (gridMap->getHeight() + clusterSize - 1) / clusterSize;
+        stats.numClusters = numClustersX * numClustersY;
+
+        clusterEntrances.assign(stats.numClusters, std::vector<uint32_t>());
+
+        for (int cy = 0; cy < numClustersY; ++cy) {
+            for (int cx = 0; cx < numClustersX; ++cx) {
+                if (cx + 1 < numClustersX) addEntrances(cx, cy, true);
+                if (cy + 1 < numClustersY) addEntrances(cx, cy, false);
+            }
+        }
+
+        for (const std::vector<uint32_t>& entrances : clusterEntrances) {
+            clusterGraph->clear();
+
+            for (uint32_t frNode : entrances) {
+                for (uint32_t toNode : entrances) addClusterEdge(frNode, toNode);
+            }
+        }
+
+        stats.numEntrances = abstractCells.size();
+        stats.numAbstractEdges = abstractGraph.getNumEdges();
+        stats.preprocessMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    };
+
+
+    std::vector<GridState> getOptimalPath(GridState start, GridState end) {
+        std::vector<GridState> statesPath;
+
+        uint32_t startId = start.getUniqueId();
+        uint32_t endId = end.getUniqueId();
+
+        // Query nodes and edges are rolled back once the path is refined
+        unsigned int numEntrances = abstractCells.size();
+        unsigned int numEdges = abstractGraph.getNumEdges();
+
+        const uint32_t* startEntrance = entranceNodes.find(startId);
+        const uint32_t* endEntrance = entranceNodes.find(endId);
+
+        uint32_t startNode = startEntrance != nullptr ? *startEntrance : queryNode(startId);
+        uint32_t endNode = endEntrance != nullptr ? *endEntrance : (endId == startId ? startNode : queryNode(endId));
+
+        if (startEntrance == nullptr) {
+            clusterGraph->clear();
+            for (uint32_t entrance : clusterEntrances[clusterOf(startId)]) addClusterEdge(startNode, entrance);
+            if (endEntrance == nullptr && clusterOf(endId) == clusterOf(startId)) addClusterEdge(startNode, endNode);
+        }
+        if (endEntrance == nullptr) {
+            clusterGraph->clear();
+            for (uint32_t entrance : clusterEntrances[clusterOf(endId)]) addClusterEdge(entrance, endNode);
+        }
+
+        std::vector<uint32_t> abstractPath = idpAlgorithm.getOptimalPath(abstractGraph, multicostArray, startNode, endNode);
+
+        for (unsigned int i = 0; i + 1 < abstractPath.size(); ++i) {
+            for (const MulticostEdge& edge : abstractGraph.getNextEdges(abstractPath[i], 0)) {
+                if (edge.nodeId != abstractPath[i + 1]) continue;
+
+                const std::vector<uint32_t>& refinedPath = abstractPaths[edge.edgeCostId];
+                for (unsigned int j = (i == 0 ? 0 : 1); j < refinedPath.size(); ++j) {
+                    statesPath.push_back(cellOf(refinedPath[j]));
+                }
+                break;
+            }
+        }
+
+        abstractGraph.truncate(numEdges);
+        abstractPaths.resize(numEdges);
+        abstractCells.resize(numEntrances);
+
+        return statesPath;
+    };
+
+
+    const HierarchicalGridStats& getStats() const {
+        return stats;
+    };
+
+private:
+    // Runs of free border cells at least this long get an entrance at each end
+    static constexpr int MAX_SINGLE_ENTRANCE_LENGTH = 6;
+
+    std::shared_ptr<const GridMap> gridMap;
+    int clusterSize;
+
+    std::shared_ptr<MonoMulticostArray<T, SIZE>> multicostArray;
+    std::shared_ptr<MonoMulticostCompute<GridState, T, SIZE>> gridCompute;
+    std::unique_ptr<LazyMulticostGraph<ClusterGridState>> clusterGraph;
+
+    IteratedDijkstraPropagation idpAlgorithm;
+
+    StaticMulticostGraph abstractGraph;
+    // Cells of the path behind each abstract edge, indexed by edge cost id
+    std::vector<std::vector<uint32_t>> abstractPaths;
+
+    // Abstract node of every entrance cell, and cell of every abstract node
+    FlatMap<uint32_t> entranceNodes;
+    std::vector<uint32_t> abstractCells;
+    // Abstract nodes of the entrances of each cluster, indexed by cluster id
+    std::vector<std::vector<uint32_t>> clusterEntrances;
+
+    HierarchicalGridStats stats;
+
+
+    GridState cellOf(uint32_t nodeId) {
+        return GridState::cellAt(*gridMap, nodeId);
+    };
+
+    uint32_t clusterOf(uint32_t nodeId) {
+        return ClusterGridState(cellOf(nodeId), clusterSize).getClusterId();
+    };
+
+
+    // Entrances between cluster (cx, cy) and its right neighbor, or its bottom neighbor
+    void addEntrances(int cx, int cy, bool isVertical) {
+        int borderBegin = (isVertical ? cy : cx) * clusterSize;
+        int borderEnd = std::min(borderBegin + clusterSize, isVertical ? gridMap->getHeight() : gridMap->getWidth());
+        int border = ((isVertical ? cx : cy) + 1) * clusterSize - 1;
+
+        auto isFree = [&](int i) {
+            GridState inner = isVertical ? GridState(*gridMap, border, i) : GridState(*gridMap, i, border);
+            GridState outer = isVertical ? GridState(*gridMap, border + 1, i) : GridState(*gridMap, i, border + 1);
+            return !gridMap->isObstacleAt(inner.getUniqueId()) && !gridMap->isObstacleAt(outer.getUniqueId());
+        };
+
+        int runBegin = borderBegin;
+        while (runBegin < borderEnd) {
+            if (!isFree(runBegin)) {
+                ++runBegin;
+                continue;
+            }
+
+            int runEnd = runBegin;
+            while (runEnd + 1 < borderEnd && isFree(runEnd + 1)) ++runEnd;
+
+            if (runEnd - runBegin + 1 >= MAX_SINGLE_ENTRANCE_LENGTH) {
+                addEntrance(runBegin, border, isVertical);
+                addEntrance(runEnd, border, isVertical);
+            } else {
+                addEntrance((runBegin + runEnd) / 2, border, isVertical);
+            }
+
+            runBegin = runEnd + 1;
+        }
+    };
+
+
+    void addEntrance(int i, int border, bool isVertical) {
+        GridState inner = isVertical ? GridState(*gridMap, border, i) : GridState(*gridMap, i, border);
+        GridState outer = isVertical ? GridState(*gridMap, border + 1, i) : GridState(*gridMap, i, border + 1);
+
+        uint32_t innerNode = entranceNode(inner.getUniqueId());
+        uint32_t outerNode = entranceNode(outer.getUniqueId());
+
+        abstractGraph.addEdge(innerNode, outerNode, gridCompute->computeCost(inner, outer));
+        abstractPaths.push_back({inner.getUniqueId(), outer.getUniqueId()});
+        abstractGraph.addEdge(outerNode, innerNode, gridCompute->computeCost(outer, inner));
+        abstractPaths.push_back({outer.getUniqueId(), inner.getUniqueId()});
+    };
+
+
+    // Abstract node of an entrance cell, added to its cluster the first time
+    uint32_t entranceNode(uint32_t cellId) {
+        const uint32_t* node = entranceNodes.find(cellId);
+        if (node != nullptr) return *node;
+
+        uint32_t newNode = abstractCells.size();
+        entranceNodes[cellId] = newNode;
+        abstractCells.push_back(cellId);
+        clusterEntrances[clusterOf(cellId)].push_back(newNode);
+        return newNode;
+    };
+
+
+    // Abstract node of a query endpoint that is not an entrance, rolled back after the query
+    uint32_t queryNode(uint32_t cellId) {
+        abstractCells.push_back(cellId);
+        return abstractCells.size() - 1;
+    };
+
+
+    // Adds the abstract edge of the IDP path between two abstract nodes of the cluster in the cluster graph, if there is one
+    void addClusterEdge(uint32_t frAbstractNode, uint32_t toAbstractNode) {
+        if (frAbstractNode == toAbstractNode) return;
+
+        uint32_t source = clusterGraph->addNode(ClusterGridState(cellOf(abstractCells[frAbstractNode]), clusterSize));
+        uint32_t target = clusterGraph->addNode(ClusterGridState(cellOf(abstractCells[toAbstractNode]), clusterSize));
+
+        std::vector<uint32_t> clusterPath = idpAlgorithm.getOptimalPath(*clusterGraph, multicostArray, source, target);
+        if (clusterPath.empty()) return;
+
+        std::vector<uint32_t> path;
+        std::unique_ptr<MulticostID> cost = multicostArray->identity();
+
+        for (unsigned int i = 0; i < clusterPath.size(); ++i) {
+            ClusterGridState state = clusterGraph->getNode(clusterPath[i]);
+            path.push_back(state.getUniqueId());
+            if (i == 0) continue;
+
+            for (const MulticostEdge& edge : clusterGraph->getNextEdges(clusterPath[i - 1], IMulticostGraph::ALL_MONOIDS)) {
+                if (edge.nodeId != clusterPath[i]) continue;
+                cost = multicostArray->op(cost, clusterGraph->getEdgeCost(edge.edgeCostId));
+                break;
+            }
+        }
+
+        abstractGraph.addEdge(frAbstractNode, toAbstractNode, std::move(cost));
+        abstractPaths.push_back(std::move(path));
+    };
+};
+
+#endif
\ No newline at end of file
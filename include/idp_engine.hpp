@@ -0,0 +1,362 @@
+#ifndef IDP_ENGINE_H
+#define IDP_ENGINE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "multicost_array.hpp"
+#include "multicost_graph.hpp"
+
+
+/***
+    Additive Costs
+    Costs policy of IdpEngine: SIZE monoids of T under + and ordered by <.
+    A policy provides Value, NUM_MONOIDS, identity(), compare(a, b, index)
+    and op(a, b, res, index), all resolved at compile time.
+*/
+template<typename T, unsigned int SIZE>
+struct AdditiveCosts {
+    using Value = std::array<T, SIZE>;
+    static constexpr unsigned int NUM_MONOIDS = SIZE;
+
+    static Value identity() {
+        Value value;
+        value.fill(T());
+        return value;
+    };
+
+    static int compare(const Value& a, const Value& b, unsigned int index) {
+        if (a[index] < b[index]) return -1;
+        if (b[index] < a[index]) return 1;
+        return 0;
+    };
+
+    static void op(const Value& a, const Value& b, Value& res, unsigned int index) {
+        res[index] = a[index] + b[index];
+    };
+};
+
+
+
+/***
+    Compact Graph
+    Static graph of IdpEngine in compressed rows, nodes are dense indices.
+    Every edge is stored once by source and once by target, with the same id.
+*/
+template<typename Costs>
+class CompactGraph {
+public:
+    struct Edge {
+        uint32_t id;
+        uint32_t frNode;
+        uint32_t toNode;
+        typename Costs::Value cost;
+    };
+
+    struct EdgeRange {
+        const Edge* first;
+        const Edge* last;
+
+        const Edge* begin() const {
+            return first;
+        };
+
+        const Edge* end() const {
+            return last;
+        };
+    };
+
+
+    CompactGraph(uint32_t numNodes, std::vector<Edge> edges) : nodeCount(numNodes) {
+        for (uint32_t i = 0; i < edges.size(); ++i) edges[i].id = i;
+
+        nextEdges = edges;
+        prevEdges = std::move(edges);
+
+        std::stable_sort(nextEdges.begin(), nextEdges.end(), [](const Edge& a, const Edge& b) { return a.frNode < b.frNode; });
+        std::stable_sort(prevEdges.begin(), prevEdges.end(), [](const Edge& a, const Edge& b) { return a.toNode < b.toNode; });
+
+        nextOffsets = offsets(nextEdges, true);
+        prevOffsets = offsets(prevEdges, false);
+    };
+
+
+    uint32_t numNodes() const {
+        return nodeCount;
+    };
+
+    uint32_t numEdges() const {
+        return nextEdges.size();
+    };
+
+    EdgeRange getNextEdges(uint32_t node) const {
+        return {nextEdges.data() + nextOffsets[node], nextEdges.data() + nextOffsets[node + 1]};
+    };
+
+    EdgeRange getPrevEdges(uint32_t node) const {
+        return {prevEdges.data() + prevOffsets[node], prevEdges.data() + prevOffsets[node + 1]};
+    };
+
+private:
+    uint32_t nodeCount;
+
+    std::vector<Edge> nextEdges;
+    std::vector<Edge> prevEdges;
+    std::vector<uint32_t> nextOffsets;
+    std::vector<uint32_t> prevOffsets;
+
+    std::vector<uint32_t> offsets(const std::vector<Edge>& sortedEdges, bool bySource) {
+        std::vector<uint32_t> nodeOffsets(nodeCount + 1, 0);
+        for (const Edge& edge : sortedEdges) nodeOffsets[(bySource ? edge.frNode : edge.toNode) + 1]++;
+        for (uint32_t node = 0; node < nodeCount; ++node) nodeOffsets[node + 1] += nodeOffsets[node];
+        return nodeOffsets;
+    };
+};
+
+
+
+// Snapshots the graph reachable from the seeds with every monoid computed
+// nodeIds maps the dense nodes of the snapshot back to the ids of graph, which are dense as well
+template<typename Costs, typename T, unsigned int SIZE>
+CompactGraph<Costs> buildCompactGraph(IMulticostGraph& graph, MonoMulticostArray<T, SIZE>& multicostArray, const std::vector<uint32_t>& seeds, std::vector<uint32_t>& nodeIds) {
+    constexpr uint32_t NO_INDEX = ~0u;
+
+    std::vector<uint32_t> nodeToIndex;
+    std::vector<typename CompactGraph<Costs>::Edge> edges;
+    std::queue<uint32_t> queueNodes;
+
+    nodeIds.clear();
+
+    auto addNode = [&](uint32_t nodeId) {
+        if (nodeId >= nodeToIndex.size()) nodeToIndex.resize(std::max<size_t>(nodeToIndex.size() * 2, static_cast<size_t>(nodeId) + 1), NO_INDEX);
+
+        if (nodeToIndex[nodeId] == NO_INDEX) {
+            nodeToIndex[nodeId] = nodeIds.size();
+            nodeIds.push_back(nodeId);
+            queueNodes.push(nodeId);
+        }
+        return nodeToIndex[nodeId];
+    };
+
+    for (uint32_t seed : seeds) addNode(seed);
+
+    while (queueNodes.size() > 0) {
+        uint32_t nodeId = queueNodes.front();
+        queueNodes.pop();
+
+        uint32_t frNode = nodeToIndex[nodeId];
+
+        for (const MulticostEdge& edge : graph.getNextEdges(nodeId, IMulticostGraph::ALL_MONOIDS)) {
+            uint32_t toNode = addNode(edge.nodeId);
+            edges.push_back({0, frNode, toNode, multicostArray.get_values(graph.getEdgeCost(edge.edgeCostId))});
+        }
+    }
+
+    return CompactGraph<Costs>(nodeIds.size(), std::move(edges));
+};
+
+
+
+/***
+    IDP Engine
+    Iterated Dijkstra Propagation with static dispatch on the graph and the costs.
+    Graph provides numNodes(), getNextEdges(node) and getPrevEdges(node) iterating edges
+    with id, frNode, toNode and cost, such as CompactGraph. Costs is a policy such as AdditiveCosts.
+    Each monoid runs a forward and a backward Dijkstra inside the optimal edges of the previous
+    monoids and keeps the edges whose forward weight, cost and backward weight add up to the optimum.
+    Buffers are kept between queries, an engine must only run one query at a time.
+*/
+template<typename Graph, typename Costs>
+class IdpEngine {
+public:
+    using Value = typename Costs::Value;
+
+    IdpEngine(const Graph& graph, Costs costs = Costs()) : graph(graph), costs(costs) {};
+
+
+    // Returns false when end is unreachable from start
+    bool getOptimalPath(uint32_t start, uint32_t end, std::vector<uint32_t>& path) {
+        path.clear();
+        if (!optimalSubgraph(start, end)) return false;
+
+        // Bfs tree over the optimal edges, every optimal edge lies on an optimal path to end
+        std::fill(predecessors.begin(), predecessors.end(), NO_NODE);
+        predecessors[start] = start;
+
+        queueNodes.clear();
+        queueNodes.push_back(start);
+
+        for (unsigned int queueFront = 0; queueFront < queueNodes.size() && predecessors[end] == NO_NODE; ++queueFront) {
+            uint32_t node = queueNodes[queueFront];
+            for (const auto& edge : graph.getNextEdges(node)) {
+                if (!isOptimal[edge.id] || predecessors[edge.toNode] != NO_NODE) continue;
+                predecessors[edge.toNode] = node;
+                queueNodes.push_back(edge.toNode);
+            }
+        }
+
+        for (uint32_t node = end; node != start; node = predecessors[node]) path.push_back(node);
+        path.push_back(start);
+        std::reverse(path.begin(), path.end());
+
+        return true;
+    };
+
+
+    // Ids of the edges of the optimal subgraph, empty when end is unreachable
+    std::vector<uint32_t> getOptimalEdges(uint32_t start, uint32_t end) {
+        std::vector<uint32_t> optimalEdges;
+        if (!optimalSubgraph(start, end)) return optimalEdges;
+
+        for (uint32_t edgeId = 0; edgeId < isOptimal.size(); ++edgeId) {
+            if (isOptimal[edgeId]) optimalEdges.push_back(edgeId);
+        }
+        return optimalEdges;
+    };
+
+
+    // Monoid iterations skipped by the last query because its optimal subgraph was a single path
+    unsigned int getNumMonoidsSkipped() const {
+        return numMonoidsSkipped;
+    };
+
+private:
+    static constexpr uint32_t NO_NODE = ~0u;
+
+    struct QueueItem {
+        Value weight;
+        uint32_t node;
+    };
+
+    // Orders the heap on one monoid without going through std::function
+    struct QueueOrder {
+        const Costs* costs;
+        unsigned int index;
+
+        bool operator()(const QueueItem& a, const QueueItem& b) const {
+            return costs->compare(a.weight, b.weight, index) > 0;
+        };
+    };
+
+    const Graph& graph;
+    Costs costs;
+
+    std::vector<Value> forwardWeights;
+    std::vector<Value> backwardWeights;
+    std::vector<bool> forwardClosed;
+    std::vector<bool> backwardClosed;
+    std::vector<bool> isReached;
+
+    // Indexed by edge id, edges of the optimal subgraph of the monoids processed so far
+    std::vector<bool> isOptimal;
+    std::vector<uint32_t> numOptimalNextEdges;
+
+    std::vector<uint32_t> predecessors;
+    std::vector<uint32_t> queueNodes;
+    std::vector<QueueItem> heapItems;
+
+    unsigned int numMonoidsSkipped = 0;
+
+
+    bool optimalSubgraph(uint32_t start, uint32_t end) {
+        uint32_t numNodes = graph.numNodes();
+        numMonoidsSkipped = 0;
+
+        // Like IteratedDijkstraPropagation, a path needs at least one edge
+        if (start == end) return false;
+
+        forwardWeights.resize(numNodes);
+        backwardWeights.resize(numNodes);
+        predecessors.resize(numNodes);
+        numOptimalNextEdges.resize(numNodes);
+
+        // Every edge is allowed in the first iteration
+        isOptimal.assign(graph.numEdges(), true);
+
+        for (unsigned int index = 0; index < Costs::NUM_MONOIDS; ++index) {
+            dijkstra(start, index, true);
+            if (!forwardClosed[end]) return false;
+            dijkstra(end, index, false);
+
+            const Value& optimalCost = forwardWeights[end];
+            Value totalCost = costs.identity();
+
+            std::fill(numOptimalNextEdges.begin(), numOptimalNextEdges.end(), 0);
+            bool isSinglePath = true;
+
+            for (uint32_t node = 0; node < numNodes; ++node) {
+                for (const auto& edge : graph.getNextEdges(node)) {
+                    if (!isOptimal[edge.id]) continue;
+
+                    bool isOnOptimalPath = forwardClosed[node] && backwardClosed[edge.toNode];
+                    if (isOnOptimalPath) {
+                        costs.op(forwardWeights[node], edge.cost, totalCost, index);
+                        costs.op(totalCost, backwardWeights[edge.toNode], totalCost, index);
+                        isOnOptimalPath = costs.compare(totalCost, optimalCost, index) == 0;
+                    }
+
+                    isOptimal[edge.id] = isOnOptimalPath;
+                    if (isOnOptimalPath && ++numOptimalNextEdges[node] == 2) isSinglePath = false;
+                }
+            }
+
+            // Later monoids can not change a single path
+            if (isSinglePath) {
+                numMonoidsSkipped = Costs::NUM_MONOIDS - (index + 1);
+                break;
+            }
+        }
+
+        return true;
+    };
+
+
+    void dijkstra(uint32_t source, unsigned int index, bool isForward) {
+        std::vector<Value>& weights = isForward ? forwardWeights : backwardWeights;
+        std::vector<bool>& closed = isForward ? forwardClosed : backwardClosed;
+
+        closed.assign(graph.numNodes(), false);
+        isReached.assign(graph.numNodes(), false);
+
+        // Stale items are skipped when popped instead of decreasing keys
+        QueueOrder order{&costs, index};
+        heapItems.clear();
+
+        weights[source] = costs.identity();
+        heapItems.push_back({weights[source], source});
+        isReached[source] = true;
+
+        QueueItem next;
+
+        while (heapItems.size() > 0) {
+            std::pop_heap(heapItems.begin(), heapItems.end(), order);
+            QueueItem item = heapItems.back();
+            heapItems.pop_back();
+
+            if (closed[item.node]) continue;
+            closed[item.node] = true;
+
+            for (const auto& edge : isForward ? graph.getNextEdges(item.node) : graph.getPrevEdges(item.node)) {
+                if (!isOptimal[edge.id]) continue;
+
+                uint32_t nextNode = isForward ? edge.toNode : edge.frNode;
+                if (closed[nextNode]) continue;
+
+                costs.op(item.weight, edge.cost, next.weight, index);
+
+                if (!isReached[nextNode] || costs.compare(next.weight, weights[nextNode], index) < 0) {
+                    isReached[nextNode] = true;
+                    weights[nextNode] = next.weight;
+                    next.node = nextNode;
+                    heapItems.push_back(next);
+                    std::push_heap(heapItems.begin(), heapItems.end(), order);
+                }
+            }
+        }
+    };
+};
+
+#endif
\ No newline at end of file
@@ -3,27 +3,100 @@
 
 #include "multicost_graph.hpp"
 #include "multicost_array.hpp"
+#include "multicost_heuristic.hpp"
 #include "multicost_pathfind.hpp"
+#include "query_cancellation.hpp"
+#include "query_workspace.hpp"
+#include "worker_pool.hpp"
 
 
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <vector>
+
+
+// Bucketed parallel relaxation of the single monoid passes, for the monoids
+// set as additive in the multicost props (see MonoMulticostProps)
+struct DeltaStepping {
+    // Width of the buckets, edges no costlier than delta are relaxed within their bucket
+    double delta = 1.0;
+    unsigned int numThreads = 4;
+};
 
 
 class IteratedDijkstraPropagation : public IMulticostPathfind {
 public:
+    IteratedDijkstraPropagation() {};
+
+    // Goal directs every search with consistent lower bounds, searches stop once past the optimal cost
+    IteratedDijkstraPropagation(std::shared_ptr<IMulticostHeuristic> heuristic) : heuristic(heuristic) {};
+
+    // Runs the forward and backward passes of additive monoids with delta stepping on a pool of
+    // deltaStepping.numThreads threads, gives the same weights and optimal subgraph
+    // Passes of the other monoids stay sequential
+    IteratedDijkstraPropagation(DeltaStepping deltaStepping) : deltaStepping(deltaStepping), workerPool(std::make_shared<WorkerPool>(deltaStepping.numThreads)) {};
+
     std::vector<uint32_t> getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end) override;
     std::vector<uint32_t> getOptimalEdges(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end) override;
 
+    std::vector<uint32_t> getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryCancellation& cancellation, QueryProgress& progress) override;
+    std::vector<uint32_t> getOptimalEdges(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryCancellation& cancellation, QueryProgress& progress) override;
+
+    void getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, std::vector<uint32_t>& path, QueryCancellation& cancellation, QueryProgress& progress) override;
+    void getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, std::vector<uint32_t>& path, QueryWorkspace& workspace, QueryCancellation& cancellation, QueryProgress& progress) override;
+
+protected:
+    // Subclasses can build some of the monoid subgraphs differently and iterate on the rest
+    // The subgraph is owned by workspace and valid until its next query
+    virtual OptimalSubgraph& optimalSubgraph(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryWorkspace& workspace, QueryCancellation& cancellation, QueryProgress& progress);
+
+    // A monoidIndex of IMulticostGraph::ALL_MONOIDS runs the iteration on the whole multicost
+    // Returns false when cancelled, the optimal edges of the previous iteration are left untouched
+    bool iterate(OptimalSubgraph& optimalSubgraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, unsigned int index, QueryWorkspace& workspace, QueryCancellation& cancellation);
+
+    // Walks the recorded predecessors from end back to start
+    void extractPath(uint32_t start, uint32_t end, QueryWorkspace& workspace, std::vector<uint32_t>& path);
+
+    // Scratch buffers of the calling thread, used by the calls without a workspace
+    static QueryWorkspace& threadWorkspace();
+
 private:
-    OptimalSubgraph optimalSubgraph(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end);
-   
-    void forwardDijkstra(OptimalSubgraph& optimalGraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t source, unsigned int monoidIndex);
-    void backwardDijkstra(OptimalSubgraph& optimalGraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t source, unsigned int monoidIndex);
-    
-    void bfsOptimalEdgeRetrieval(OptimalSubgraph& optimalSubgraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, unsigned int monoidIndex);
+    // Delta stepping phases smaller than this per thread are relaxed on the calling thread
+    static constexpr unsigned int PARALLEL_NODES_PER_THREAD = 256;
+
+    std::shared_ptr<IMulticostHeuristic> heuristic;
+    std::optional<DeltaStepping> deltaStepping;
+    std::shared_ptr<WorkerPool> workerPool;
+
+    // Dijkstras return false when cancelled before finishing, target is only used by the heuristic
+    bool forwardDijkstra(OptimalSubgraph& optimalGraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t source, uint32_t target, unsigned int monoidIndex, QueryWorkspace& workspace, QueryCancellation& cancellation);
+    bool backwardDijkstra(OptimalSubgraph& optimalGraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t source, uint32_t target, unsigned int monoidIndex, QueryWorkspace& workspace, QueryCancellation& cancellation);
+
+    // Forward pass from source, or backward pass when not isForward, only adds the tight temp edges
+    // Node ids index its buffers in the workspace, returns false when cancelled
+    bool deltaSteppingDijkstra(OptimalSubgraph& optimalGraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t source, unsigned int monoidIndex, bool isForward, QueryWorkspace& workspace, QueryCancellation& cancellation);
+    // Only additive numeric monoids of a search without heuristic
+    bool isDeltaStepping(IMulticostArray& multicostArray, unsigned int monoidIndex);
+
+    // Also records the bfs tree predecessors in the workspace for path extraction
+    void bfsOptimalEdgeRetrieval(OptimalSubgraph& optimalSubgraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, unsigned int monoidIndex, QueryWorkspace& workspace);
     
-    void iterate(OptimalSubgraph& optimalSubgraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, unsigned int index);
+    // Single Dijkstra on the full multicost, records predecessors and stops once end is popped
+    // Only valid when multicostArray->is_lexicographic(), returns false when cancelled
+    bool lexicographicDijkstra(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryWorkspace& workspace, QueryCancellation& cancellation);
+
+    // Single monoid operations, or whole multicost operations for IMulticostGraph::ALL_MONOIDS
+    static int compareMonoid(IMulticostArray& multicostArray, const std::unique_ptr<MulticostID>& a, const std::unique_ptr<MulticostID>& b, unsigned int monoidIndex);
+    static std::unique_ptr<MulticostID> opMonoid(IMulticostArray& multicostArray, const std::unique_ptr<MulticostID>& a, const std::unique_ptr<MulticostID>& b, unsigned int monoidIndex);
+    static void opMonoid(IMulticostArray& multicostArray, const std::unique_ptr<MulticostID>& a, const std::unique_ptr<MulticostID>& b, const std::unique_ptr<MulticostID>& res, unsigned int monoidIndex);
+    static bool isIdentityMonoid(IMulticostArray& multicostArray, const std::unique_ptr<MulticostID>& a, unsigned int monoidIndex);
+
+    // True when weight composed with edgeCost is exactly nextWeight
+    static bool isTightEdge(IMulticostArray& multicostArray, const std::unique_ptr<MulticostID>& weight, const std::unique_ptr<MulticostID>& edgeCost, const std::unique_ptr<MulticostID>& nextWeight, unsigned int monoidIndex);
+
+    // Uses lowerBound as scratch for the heuristic bound from frNodeId to toNodeId
+    SearchCost makeSearchCost(IMulticostArray& multicostArray, std::unique_ptr<MulticostID> weight, uint32_t frNodeId, uint32_t toNodeId, unsigned int monoidIndex, const std::unique_ptr<MulticostID>& lowerBound);
 
 };
 
@@ -0,0 +1,222 @@
+#ifndef LANDMARK_HEURISTIC_H
+#define LANDMARK_HEURISTIC_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "multicost_array.hpp"
+#include "multicost_graph.hpp"
+#include "multicost_heuristic.hpp"
+#include "multicost_pathfind.hpp"
+
+
+/***
+    Landmark Heuristic (ALT)
+    Preprocesses, for every monoid, the costs from and to a few landmarks over the
+    whole graph reachable from the seeds, and bounds queries with the triangle inequality:
+        cost(u, v) >= cost(L, v) - cost(L, u)   and   cost(u, v) >= cost(u, L) - cost(v, L)
+    Requires monoids whose operator is the addition of T, ordered by the < of T,
+    with costs no smaller than the identity. Landmarks are picked farthest first on monoid 0.
+    The tables must be rebuilt when the graph changes, smaller costs would break the bounds.
+    Node ids are dense (see IMulticostGraph), so the tables are indexed by node id directly.
+*/
+template<typename T, unsigned int SIZE>
+class LandmarkHeuristic : public IMulticostHeuristic, public IMulticostPreprocess {
+public:
+    LandmarkHeuristic(unsigned int numLandmarks = 8) : numLandmarks(numLandmarks) {};
+
+
+    void preprocess(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, const std::vector<uint32_t>& seeds) override {
+        monoArray = std::dynamic_pointer_cast<MonoMulticostArray<T, SIZE>>(multicostArray);
+        if (!monoArray) {
+            std::cerr << "ERROR: [LandmarkHeuristic::preprocess] multicost array is not a MonoMulticostArray of the heuristic type." << std::endl;
+            exit(1);
+        }
+
+        identityCosts = monoArray->get_values(monoArray->identity());
+
+        nodes.clear();
+        explored.clear();
+        landmarks.clear();
+        fromLandmarks.clear();
+        toLandmarks.clear();
+
+        explore(graph, seeds);
+        if (nodes.size() == 0) return;
+
+        // Farthest first: the next landmark maximizes its smallest cost from the chosen ones
+        std::vector<T> minCosts;
+        std::vector<bool> minReached(explored.size(), false);
+
+        LandmarkTable seedTable = dijkstra(graph, seeds[0], 0, true);
+        uint32_t nextLandmark = farthest(seedTable.costs, seedTable.reached);
+
+        while (landmarks.size() < numLandmarks) {
+            landmarks.push_back(nextLandmark);
+
+            for (unsigned int k = 0; k < SIZE; ++k) {
+                fromLandmarks.push_back(dijkstra(graph, nextLandmark, k, true));
+                toLandmarks.push_back(dijkstra(graph, nextLandmark, k, false));
+            }
+
+            const LandmarkTable& table = fromLandmarks[fromLandmarks.size() - SIZE];
+
+            if (minCosts.size() == 0) {
+                minCosts = table.costs;
+                minReached = table.reached;
+            } else {
+                for (uint32_t node : nodes) {
+                    if (!table.reached[node]) continue;
+                    if (!minReached[node] || table.costs[node] < minCosts[node]) minCosts[node] = table.costs[node];
+                    minReached[node] = true;
+                }
+            }
+
+            nextLandmark = farthest(minCosts, minReached);
+            if (std::find(landmarks.begin(), landmarks.end(), nextLandmark) != landmarks.end()) break;
+        }
+    };
+
+
+    void lowerBound(uint32_t frNodeId, uint32_t toNodeId, unsigned int index, const std::unique_ptr<MulticostID>& res) override {
+        std::array<T, SIZE> values;
+        values[index] = identityCosts[index];
+
+        // Nodes past the explored ids are in no table, the others are skipped by their reached flags
+        if (frNodeId < explored.size() && toNodeId < explored.size()) {
+            uint32_t u = frNodeId;
+            uint32_t v = toNodeId;
+            T& bound = values[index];
+
+            for (unsigned int l = 0; l < landmarks.size(); ++l) {
+                const LandmarkTable& fromTable = fromLandmarks[l * SIZE + index];
+                const LandmarkTable& toTable = toLandmarks[l * SIZE + index];
+
+                if (fromTable.reached[u] && fromTable.reached[v] && bound < fromTable.costs[v] - fromTable.costs[u]) {
+                    bound = fromTable.costs[v] - fromTable.costs[u];
+                }
+                if (toTable.reached[u] && toTable.reached[v] && bound < toTable.costs[u] - toTable.costs[v]) {
+                    bound = toTable.costs[u] - toTable.costs[v];
+                }
+            }
+        }
+
+        monoArray->copy(res, values, index);
+    };
+
+
+    std::vector<uint32_t> getLandmarks() const {
+        return landmarks;
+    };
+
+private:
+    struct LandmarkTable {
+        std::vector<T> costs;
+        std::vector<bool> reached;
+    };
+
+    unsigned int numLandmarks;
+
+    std::shared_ptr<MonoMulticostArray<T, SIZE>> monoArray;
+    std::array<T, SIZE> identityCosts;
+
+    // Node ids reachable from the seeds, flagged in explored which also sizes the tables
+    std::vector<uint32_t> nodes;
+    std::vector<bool> explored;
+
+    std::vector<uint32_t> landmarks;
+    // Indexed by landmark * SIZE + monoid, then by node id
+    std::vector<LandmarkTable> fromLandmarks;
+    std::vector<LandmarkTable> toLandmarks;
+
+
+    // Expands every reachable node and computes its edge costs on all monoids
+    void explore(IMulticostGraph& graph, const std::vector<uint32_t>& seeds) {
+        std::queue<uint32_t> queueNodes;
+
+        for (uint32_t seed : seeds) {
+            if (!addNode(seed)) continue;
+            queueNodes.push(seed);
+        }
+
+        while (queueNodes.size() > 0) {
+            uint32_t nodeId = queueNodes.front();
+            queueNodes.pop();
+
+            for (const MulticostEdge& edge : graph.getNextEdges(nodeId, IMulticostGraph::ALL_MONOIDS)) {
+                if (!addNode(edge.nodeId)) continue;
+                queueNodes.push(edge.nodeId);
+            }
+        }
+    };
+
+
+    // False when nodeId was already explored
+    bool addNode(uint32_t nodeId) {
+        if (nodeId >= explored.size()) explored.resize(std::max<size_t>(explored.size() * 2, static_cast<size_t>(nodeId) + 1), false);
+        if (explored[nodeId]) return false;
+
+        explored[nodeId] = true;
+        nodes.push_back(nodeId);
+        return true;
+    };
+
+
+    LandmarkTable dijkstra(IMulticostGraph& graph, uint32_t source, unsigned int index, bool isForward) {
+        LandmarkTable table;
+        table.costs = std::vector<T>(explored.size(), identityCosts[index]);
+        table.reached = std::vector<bool>(explored.size(), false);
+
+        std::vector<bool> closed(explored.size(), false);
+        std::priority_queue<std::pair<T, uint32_t>, std::vector<std::pair<T, uint32_t>>, std::greater<std::pair<T, uint32_t>>> heap;
+
+        heap.push({identityCosts[index], source});
+        table.reached[source] = true;
+
+        while (heap.size() > 0) {
+            auto [cost, node] = heap.top();
+            heap.pop();
+
+            if (closed[node]) continue;
+            closed[node] = true;
+
+            const std::vector<MulticostEdge>& edges = isForward ?
+                graph.getNextEdges(node, index) :
+                graph.getPrevEdges(node, index);
+
+            for (const MulticostEdge& edge : edges) {
+                uint32_t nextNode = edge.nodeId;
+                if (nextNode >= explored.size() || !explored[nextNode] || closed[nextNode]) continue;
+
+                T nextCost = cost + monoArray->get_values(graph.getEdgeCost(edge.edgeCostId))[index];
+
+                if (!table.reached[nextNode] || nextCost < table.costs[nextNode]) {
+                    table.costs[nextNode] = nextCost;
+                    table.reached[nextNode] = true;
+                    heap.push({nextCost, nextNode});
+                }
+            }
+        }
+
+        return table;
+    };
+
+
+    uint32_t farthest(const std::vector<T>& costs, const std::vector<bool>& reached) {
+        uint32_t farthestNode = nodes[0];
+
+        for (uint32_t node : nodes) {
+            if (reached[node] && (!reached[farthestNode] || costs[farthestNode] < costs[node])) farthestNode = node;
+        }
+
+        return farthestNode;
+    };
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef MOVING_AI_BENCHMARK_H
+#define MOVING_AI_BENCHMARK_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "grid_map.hpp"
+
+// One query of a .scen file, optimalLength is the published octile distance
+struct MovingAiScenario {
+    unsigned int bucket = 0;
+    // Size of the map the scenario was made for
+    int mapWidth = 0;
+    int mapHeight = 0;
+    int startX = 0;
+    int startY = 0;
+    int goalX = 0;
+    int goalY = 0;
+    double optimalLength = 0;
+};
+
+struct MovingAiQueryResult {
+    unsigned int bucket = 0;
+    bool isSolved = false;
+    // Octile length of the path found
+    double length = 0;
+    double optimalLength = 0;
+    double milliseconds = 0;
+    // States expanded and stored by the query
+    unsigned int numExpansions = 0;
+    unsigned int numNodes = 0;
+    // Heap of the query above the heap in use before it, 0 without a heap meter
+    int64_t peakHeapBytes = 0;
+    uint64_t numAllocations = 0;
+};
+
+struct MovingAiBucketResult {
+    unsigned int bucket = 0;
+    unsigned int numQueries = 0;
+    uint64_t numExpansions = 0;
+    // Queries without a path although the scenario has one
+    unsigned int numUnsolved = 0;
+    // Paths longer than the published optimal length
+    unsigned int numSuboptimal = 0;
+    double totalMilliseconds = 0;
+    double maxMilliseconds = 0;
+    int64_t maxPeakHeapBytes = 0;
+};
+
+
+// Heap usage of the process, as seen by a counting operator new
+class IHeapMeter {
+public:
+    virtual ~IHeapMeter() {};
+
+    virtual int64_t getBytesInUse() = 0;
+    // Highest bytes in use since the last resetPeak
+    virtual int64_t getPeakBytes() = 0;
+    virtual void resetPeak() = 0;
+    virtual uint64_t getNumAllocations() = 0;
+};
+
+
+/***
+    MovingAI Benchmark
+    Loads the grid maps and scenarios of the MovingAI benchmark sets (movingai.com/benchmarks).
+    Files are read in a single block and parsed in place, map rows go straight into the row
+    major occupancy handed to GridMap::setObstacles. '.', 'G' and 'S' cells are free, every
+    other terrain is an obstacle. Loaders return false on unreadable or malformed files,
+    and report the line of a malformed scenario on std::cerr.
+*/
+bool loadMovingAiMap(const std::string& path, std::shared_ptr<GridMap>& map, GridLayout layout = GridLayout::ROW_MAJOR);
+
+// Rows need their nine fields and start and goal inside the map size of the row
+bool loadMovingAiScenarios(const std::string& path, std::vector<MovingAiScenario>& scenarios);
+
+// Also rejects rows made for a map of another size than map
+bool loadMovingAiScenarios(const std::string& path, const GridMap& map, std::vector<MovingAiScenario>& scenarios);
+
+// Runs every scenario through IteratedDijkstraPropagation on 8 connected TerrainGridStates,
+// the octile moves without corner cutting of the published lengths, and groups them by bucket
+// Every query gets a new planner and graph, so its latency, expansions and heap are its own
+// Scenarios must fit the map, as checked by loadMovingAiScenarios with the map
+std::vector<MovingAiBucketResult> runMovingAiScenarios(std::shared_ptr<const GridMap> map, const std::vector<MovingAiScenario>& scenarios);
+
+// Also records every query in queries, in the order of scenarios, with its heap when heapMeter is given
+std::vector<MovingAiBucketResult> runMovingAiScenarios(std::shared_ptr<const GridMap> map, const std::vector<MovingAiScenario>& scenarios, std::vector<MovingAiQueryResult>& queries, IHeapMeter* heapMeter = nullptr);
+
+#endif
\ No newline at end of file
@@ -14,6 +14,11 @@
     Used to deal with Multicost with same Monoid data types
     Note that the compare and the operation functions can be different
     Assumes that Multicost is implemented with an array
+    Set lexicographic when every monoid is totally ordered, its operator is strictly
+    monotone (such as addition) and no cost is smaller than the identity. The
+    hierarchical optimum is then the lexicographic optimum and can be found in one Dijkstra.
+    Set additive[i] when monoid i is the addition of non-negative numbers ordered by value,
+    its passes can then run with delta stepping.
 */
 template <typename T, unsigned int SIZE>
 class MonoMulticostProps {
@@ -21,14 +26,28 @@ public:
     MonoMulticostProps( 
             std::array<T, SIZE> identity_multicost,
             std::array<std::function<int(T a, T b)>, SIZE> compares,
-            std::array<std::function<T(T a, T b)>, SIZE> operators
+            std::array<std::function<T(T a, T b)>, SIZE> operators,
+            bool lexicographic = false,
+            std::array<bool, SIZE> additive = {}
         ) :
             identity_multicost(identity_multicost),
             compares(compares),
-            operators(operators)   
+            operators(operators),
+            lexicographic(lexicographic),
+            additive(additive)
     {};
 
 
+    bool is_lexicographic() const {
+        return this->lexicographic;
+    };
+
+
+    bool is_additive(unsigned int index) const {
+        return index < SIZE && this->additive[index];
+    };
+
+
     // Return a copy of identity
     std::array<T, SIZE> identity() const {
         return this->identity_multicost;
@@ -89,6 +108,8 @@ private:
     std::array<std::function<int(T a, T b)>, SIZE> compares;
     std::array<std::function<T(T a, T b)>, SIZE> operators;
     std::array<T, SIZE> identity_multicost;
+    bool lexicographic;
+    std::array<bool, SIZE> additive;
 };
 
 
@@ -98,6 +119,7 @@ private:
     Used to deal with Multicost with varying Monoid data types
     Assumes that Multicost is implemented with a tuple
     Can be slow when selecting a specific element (looping over each type until one is reached)
+    See MonoMulticostProps for the meaning of lexicographic and additive
 */
 template <typename ...Ts>
 class PolyMulticostProps {
@@ -105,13 +127,27 @@ public:
     PolyMulticostProps( 
         Ts ...identities,
         std::function<int(Ts a, Ts b)> ...compares,
-        std::function<Ts(Ts a, Ts b)> ...operators) :
+        std::function<Ts(Ts a, Ts b)> ...operators,
+        bool lexicographic = false,
+        std::array<bool, sizeof...(Ts)> additive = {}) :
             identity_multicost(identities...),
             compares(std::make_tuple(compares...)),
-            operators(std::make_tuple(operators...))   
+            operators(std::make_tuple(operators...)),
+            lexicographic(lexicographic),
+            additive(additive)
     {};
 
 
+    bool is_lexicographic() const {
+        return this->lexicographic;
+    };
+
+
+    bool is_additive(unsigned int index) const {
+        return index < sizeof...(Ts) && this->additive[index];
+    };
+
+
     // Return a copy of identity
     std::tuple<Ts...> identity() const {
         return this->identity_multicost;
@@ -166,6 +202,8 @@ private:
     std::tuple<std::function<int(Ts a, Ts b)>...> compares;
     std::tuple<std::function<Ts(Ts a, Ts b)>...> operators;
     std::tuple<Ts...> identity_multicost;
+    bool lexicographic;
+    std::array<bool, sizeof...(Ts)> additive;
     
     template <std::size_t... Is>
     std::tuple<Ts...> op_impl(const std::tuple<Ts...>& a, const std::tuple<Ts...>& b, std::index_sequence<Is...>) const {
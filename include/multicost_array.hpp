@@ -2,7 +2,10 @@
 #define MULTICOST_ARRAY_H
 
 #include <array>
+#include <cstddef>
 #include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include "multicost.hpp"
@@ -25,6 +28,12 @@ public:
     virtual unsigned int num_values() const = 0;
     virtual unsigned int allocated_size() const = 0;
     virtual unsigned int num_monoids() const = 0;
+    // True when a single Dijkstra on the full lexicographic compare finds the hierarchical optimum
+    virtual bool is_lexicographic() const = 0;
+    // True when the monoid at index is the addition of non-negative numbers ordered by value
+    virtual bool is_additive(unsigned int index) const = 0;
+    // Writes the value of the monoid at index as a double, false when its type is not arithmetic
+    virtual bool get_numeric(const std::unique_ptr<MulticostID>& id, unsigned int index, double& value) const = 0;
 
 protected:
     std::unique_ptr<MulticostID> make_id(unsigned int id);
@@ -48,6 +57,10 @@ public:
 
     ~MulticostID();
 
+    // IDs are recycled through a free list of the calling thread, so steady state queries do not allocate them
+    static void* operator new(std::size_t size);
+    static void operator delete(void* pointer);
+
 private:
     std::weak_ptr<IMulticostArray> multicost_array;
     unsigned int id;
@@ -55,6 +68,32 @@ private:
     MulticostID(std::weak_ptr<IMulticostArray>multicost_array, unsigned int id) :
         multicost_array(multicost_array), id(id) {}
 
+    // Freed blocks beyond this are returned to the global allocator
+    static constexpr unsigned int MAX_FREE_IDS = 1 << 16;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // Returns its blocks to the global allocator when the thread exits
+    struct FreeList {
+        FreeBlock* head = nullptr;
+        unsigned int size = 0;
+
+        ~FreeList();
+    };
+
+    static FreeList& freeList() {
+        thread_local FreeList list;
+        return list;
+    };
+
+    // Trivially destructible, ids freed by thread locals destroyed after the free list skip it
+    static bool& isFreeListDestroyed() {
+        thread_local bool isDestroyed = false;
+        return isDestroyed;
+    };
+
     friend IMulticostArray;
 };
 
@@ -68,6 +107,46 @@ inline MulticostID::~MulticostID() {
     }
 };
 
+inline MulticostID::FreeList::~FreeList() {
+    while (head != nullptr) {
+        FreeBlock* block = head;
+        head = block->next;
+        ::operator delete(block);
+    }
+    size = 0;
+    isFreeListDestroyed() = true;
+};
+
+inline void* MulticostID::operator new(std::size_t size) {
+    if (isFreeListDestroyed()) return ::operator new(size);
+
+    FreeList& list = freeList();
+    if (list.head == nullptr) return ::operator new(size);
+
+    FreeBlock* block = list.head;
+    list.head = block->next;
+    list.size -= 1;
+    return block;
+};
+
+inline void MulticostID::operator delete(void* pointer) {
+    if (isFreeListDestroyed()) {
+        ::operator delete(pointer);
+        return;
+    }
+
+    FreeList& list = freeList();
+    if (list.size >= MAX_FREE_IDS) {
+        ::operator delete(pointer);
+        return;
+    }
+
+    FreeBlock* block = static_cast<FreeBlock*>(pointer);
+    block->next = list.head;
+    list.head = block;
+    list.size += 1;
+};
+
 
 
 
@@ -209,6 +288,29 @@ public:
         return SIZE;
     }
 
+
+
+    bool is_lexicographic() const override {
+        return props.is_lexicographic();
+    }
+
+
+
+    bool is_additive(unsigned int index) const override {
+        return props.is_additive(index);
+    }
+
+
+
+    bool get_numeric(const std::unique_ptr<MulticostID>& id, unsigned int index, double& value) const override {
+        if constexpr (std::is_arithmetic<T>::value) {
+            value = static_cast<double>(values[id->get_id()][index]);
+            return true;
+        } else {
+            return false;
+        }
+    }
+
 private:
     std::vector<std::array<T, SIZE>> values;
     MonoMulticostProps<T, SIZE> props;
@@ -359,6 +461,24 @@ public:
         return this->size;
     }
 
+
+
+    bool is_lexicographic() const override {
+        return props.is_lexicographic();
+    }
+
+
+
+    bool is_additive(unsigned int index) const override {
+        return props.is_additive(index);
+    }
+
+
+
+    bool get_numeric(const std::unique_ptr<MulticostID>& id, unsigned int index, double& value) const override {
+        return get_numeric_impl(values[id->get_id()], index, value);
+    }
+
 private:
     std::vector<std::tuple<Ts...>> values;
     PolyMulticostProps<Ts...> props;
@@ -383,6 +503,24 @@ private:
             exit(1);
         }
     }
+
+    template <unsigned int I = 0>
+    bool get_numeric_impl(const std::tuple<Ts...>& src, unsigned int index, double& value) const {
+        constexpr unsigned int size = sizeof...(Ts);
+        if constexpr (I < size) {
+            if (I != index) return get_numeric_impl<I + 1>(src, index, value);
+
+            if constexpr (std::is_arithmetic<typename std::tuple_element<I, std::tuple<Ts...>>::type>::value) {
+                value = static_cast<double>(std::get<I>(src));
+                return true;
+            } else {
+                return false;
+            }
+        } else {
+            std::cerr << "Invalid Index." << std::endl;
+            exit(1);
+        }
+    }
 };
 
 
@@ -5,6 +5,7 @@
 #include <array>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 template<typename S>
 class IMulticostCompute {
@@ -12,6 +13,23 @@ public:
     virtual std::unique_ptr<MulticostID> computeCost(S& a, S& b) = 0;
     virtual std::unique_ptr<MulticostID> computeCost(S& a, S& b,  unsigned int index) = 0;
     virtual void computeCost(S& a, S& b, const std::unique_ptr<MulticostID>& dest, unsigned int index) = 0;
+
+    // Batches of the edges from a to the numStates states of bs, written into dests[0, numStates)
+    // Every monoid, in new multicosts
+    virtual void computeCosts(S& a, S* bs, unsigned int numStates, std::unique_ptr<MulticostID>* dests) {
+        for (unsigned int i = 0; i < numStates; ++i) dests[i] = computeCost(a, bs[i]);
+    };
+
+    // The monoid at index, into the existing multicosts or in new ones where dests are null
+    virtual void computeCosts(S& a, S* bs, unsigned int numStates, std::unique_ptr<MulticostID>* dests, unsigned int index) {
+        for (unsigned int i = 0; i < numStates; ++i) {
+            if (dests[i]) {
+                computeCost(a, bs[i], dests[i], index);
+            } else {
+                dests[i] = computeCost(a, bs[i], index);
+            }
+        }
+    };
 };
 
 
@@ -72,13 +90,46 @@ private:
 
 
 
+/***
+    Mono Multicost Compute
+    Computes every monoid with its own function. A monoid can instead be given a batch function
+    that writes the costs of the edges from a to numStates states into costs in one call, so it
+    can share setup or lookups between the neighbors of a state and vectorize over them.
+    Batches reuse a scratch buffer, a compute must only serve one graph at a time.
+*/
 template<typename S, typename T, unsigned int SIZE>
 class MonoMulticostCompute : public IMulticostCompute<S> {
 public:
+    using BatchCompute = std::function<void(S& a, S* bs, unsigned int numStates, T* costs)>;
+
     MonoMulticostCompute(
         std::shared_ptr<MonoMulticostArray<T, SIZE>> multicost_array, 
         std::array<std::function<T(S& a, S& b)>, SIZE> computes
-    ) : multicost_array(multicost_array), computes(computes) {};
+    ) : multicost_array(multicost_array), computes(computes) {
+
+        for (unsigned int i = 0; i < SIZE; ++i) {
+            std::function<T(S& a, S& b)> compute = computes[i];
+            batchComputes[i] = [compute](S& a, S* bs, unsigned int numStates, T* costs) {
+                for (unsigned int j = 0; j < numStates; ++j) costs[j] = compute(a, bs[j]);
+            };
+        }
+    };
+
+
+    MonoMulticostCompute(
+        std::shared_ptr<MonoMulticostArray<T, SIZE>> multicost_array,
+        std::array<BatchCompute, SIZE> batchComputes
+    ) : multicost_array(multicost_array), batchComputes(batchComputes) {
+
+        for (unsigned int i = 0; i < SIZE; ++i) {
+            BatchCompute batchCompute = batchComputes[i];
+            computes[i] = [batchCompute](S& a, S& b) {
+                T cost;
+                batchCompute(a, &b, 1, &cost);
+                return cost;
+            };
+        }
+    };
 
 
     std::unique_ptr<MulticostID> computeCost(S& a, S& b) override {
@@ -104,10 +155,42 @@ public:
     };
 
 
+    void computeCosts(S& a, S* bs, unsigned int numStates, std::unique_ptr<MulticostID>* dests) override {
+        batchCosts.resize(numStates);
+
+        for (unsigned int k = 0; k < SIZE; ++k) {
+            batchMonoidCosts.resize(numStates);
+            batchComputes[k](a, bs, numStates, batchMonoidCosts.data());
+            for (unsigned int i = 0; i < numStates; ++i) batchCosts[i][k] = batchMonoidCosts[i];
+        }
+
+        for (unsigned int i = 0; i < numStates; ++i) dests[i] = multicost_array->make_multicost(std::move(batchCosts[i]));
+    };
+
+
+    void computeCosts(S& a, S* bs, unsigned int numStates, std::unique_ptr<MulticostID>* dests, unsigned int index) override {
+        batchMonoidCosts.resize(numStates);
+        batchComputes[index](a, bs, numStates, batchMonoidCosts.data());
+
+        std::array<T, SIZE> costs;
+        for (unsigned int i = 0; i < numStates; ++i) {
+            costs[index] = batchMonoidCosts[i];
+            if (dests[i]) {
+                multicost_array->copy(dests[i], costs, index);
+            } else {
+                dests[i] = multicost_array->make_multicost(std::move(costs));
+            }
+        }
+    };
+
+
 private:
     std::shared_ptr<MonoMulticostArray<T, SIZE>> multicost_array;
     std::array<std::function<T(S& a, S& b)>, SIZE> computes;
+    std::array<BatchCompute, SIZE> batchComputes;
 
+    std::vector<std::array<T, SIZE>> batchCosts;
+    std::vector<T> batchMonoidCosts;
 };
 
 #endif
\ No newline at end of file
@@ -1,24 +1,35 @@
 #ifndef MULTICOST_GRAPH_H
 #define MULTICOST_GRAPH_H
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
-#include <unordered_map>
+#include <type_traits>
 #include <utility>
 #include <vector>
+#include "flat_map.hpp"
 #include "multicost_array.hpp"
 #include "multicost_compute.hpp"
 
+/***
+    Multicost Edge
+    Stored in the edge list of one of its nodes, which gives the other end implicitly:
+    nodeId is the target in next edge lists and the source in prev edge lists.
+    edgeCostId indexes the edge costs of the graph, everything else per edge derives from it.
+*/
 struct MulticostEdge {
-    uint32_t frNodeId;
-    uint32_t toNodeId;
-    unsigned int computedCostIndexBegin;
-    unsigned int edgeCostId;
+    uint32_t nodeId;
+    uint32_t edgeCostId;
 };
 
 
+// Node ids index the dense arrays of the searches (VisitedSet, Heap, NodeWeights), so they
+// should be numbered from 0 without large gaps, as LazyMulticostGraph does
 class IMulticostGraph {
 public:
+    // computeIndex that computes the edge costs of every monoid
+    static constexpr unsigned int ALL_MONOIDS = ~0u;
+
     virtual std::vector<MulticostEdge>& getNextEdges(uint32_t id, unsigned int computeIndex) = 0;
     virtual std::vector<MulticostEdge>& getPrevEdges(uint32_t id, unsigned int computeIndex) = 0;
 
@@ -29,37 +40,66 @@ public:
 
 
 
+// True when S writes its next states into a caller buffer of S::MAX_NEXT_STATES states
+// with unsigned int getNextStates(S* nextStates), instead of returning a new vector
+template<typename S, typename = void>
+struct HasNextStatesBuffer : std::false_type {};
+
+template<typename S>
+struct HasNextStatesBuffer<S, std::void_t<decltype(S::MAX_NEXT_STATES), decltype(std::declval<S&>().getNextStates(std::declval<S*>()))>> : std::true_type {};
+
+
+
+/***
+    Lazy Multicost Graph
+    Expands the states of S on demand. Nodes get dense indices in order of discovery,
+    these indices are the node ids seen by the search algorithms, so their per node
+    storage can be plain arrays whatever the ids returned by getUniqueId.
+    Callers translate at the boundary with addNode / getNodeIndex and getNode.
+    States with HasNextStatesBuffer are expanded into a stack buffer without allocating.
+    The edges of a node are computed in one batch per monoid through IMulticostCompute::computeCosts.
+*/
 template<typename S>
 class LazyMulticostGraph : public IMulticostGraph {
 public:
+    static constexpr uint32_t NO_NODE = ~0u;
+
     LazyMulticostGraph (
         std::shared_ptr<IMulticostArray> multicostArray, 
         std::shared_ptr<IMulticostCompute<S>> compute
     ) : multicostArray(multicostArray), compute(compute) { } ;
 
     void computeEdgesAtIndex(uint32_t id, unsigned int computeIndex) override {
-        S currentState = nodes[id];
-
-        for (MulticostEdge nextEdge : mapNextEdges[id]) {
-            unsigned computedCostIndexBegin = nextEdge.computedCostIndexBegin;
-            if (!computedCost[computedCostIndexBegin + computeIndex]) {
-                compute->computeCost(currentState, nodes[nextEdge.toNodeId], edgeCosts[nextEdge.edgeCostId], computeIndex);
-                computedCost[computedCostIndexBegin + computeIndex] = true;
-            }
+        if (computeIndex == ALL_MONOIDS) {
+            for (unsigned int k = 0; k < multicostArray->num_monoids(); ++k) computeEdgesAtIndex(id, k);
+            return;
         }
-    }
 
-    std::vector<MulticostEdge>& getNextEdges(uint32_t id, unsigned int computeIndex) override {
+        std::vector<MulticostEdge>& edges = nextEdges[id];
+        if (edges.size() == 0) return;
+
+        unsigned int numMonoids = multicostArray->num_monoids();
+
+        // The edges of a node are computed together, their cost ids are consecutive
+        uint32_t firstEdgeCostId = edges[0].edgeCostId;
+        if (computedCost[firstEdgeCostId * numMonoids + computeIndex]) return;
+
+        batchStates.clear();
+        for (MulticostEdge nextEdge : edges) batchStates.push_back(nodes[nextEdge.nodeId]);
 
-        S currentState = nodes[id];
+        compute->computeCosts(nodes[id], batchStates.data(), edges.size(), edgeCosts.data() + firstEdgeCostId, computeIndex);
 
-        if (mapNextEdges.find(id) == mapNextEdges.end()) {
-            addNextEdges(currentState, computeIndex);
+        for (unsigned int i = 0; i < edges.size(); ++i) computedCost[(firstEdgeCostId + i) * numMonoids + computeIndex] = true;
+    }
+
+    std::vector<MulticostEdge>& getNextEdges(uint32_t id, unsigned int computeIndex) override {
+        if (!isExpanded[id]) {
+            addNextEdges(id, computeIndex);
         } else {
             computeEdgesAtIndex(id, computeIndex);
         }
 
-        return mapNextEdges[id];
+        return nextEdges[id];
     };
     
 
@@ -69,29 +109,59 @@ public:
         // this function assume that the backward edges computation on computeIndex are computed in the getNextEdges
         // id does not exist in backward edges
 
-        return mapPrevEdges[id];
+        return prevEdges[id];
+    };
+
+
+    // Returns the node id of state, the state replaces the one already stored under its unique id
+    uint32_t addNode(S state) {
+        uint32_t id = discoverNode(state);
+        nodes[id] = state;
+        return id;
     };
 
+    // NO_NODE when the state was never added nor discovered
+    uint32_t getNodeIndex(uint32_t uniqueId) const {
+        const uint32_t* id = nodeIndices.find(uniqueId);
+        return id == nullptr ? NO_NODE : *id;
+    };
 
-    void addNode(S state) {
-        nodes[state.getUniqueId()] = state;
+    const S& getNode(uint32_t id) const {
+        return nodes[id];
     };
 
+    uint32_t getNumNodes() const {
+        return nodes.size();
+    };
 
-    const std::unordered_map<uint32_t, S>& getNodes() {
-        return nodes;
+    // Nodes whose next states were generated since the last clear
+    unsigned int getNumExpandedNodes() const {
+        return numExpandedNodes;
     };
 
-    bool isNodeExists(uint32_t nodeId) {
-        return nodes.find(nodeId) != nodes.end();
+    bool isNodeExists(uint32_t uniqueId) {
+        return nodeIndices.contains(uniqueId);
     } 
 
-    // Clear all multicosts
+    // Sizes the node storage for numNodes nodes, so lazy expansion does not reallocate
+    void reserve(size_t numNodes) {
+        nodeIndices.reserve(numNodes);
+        nodes.reserve(numNodes);
+        isExpanded.reserve(numNodes);
+        nextEdges.reserve(numNodes);
+        prevEdges.reserve(numNodes);
+    }
+
+    // Clear all multicosts, node ids are assigned again from 0
     void clear() {
+        edgeCosts.clear();
         computedCost.clear();
+        nodeIndices.clear();
         nodes.clear();
-        mapNextEdges.clear();
-        mapPrevEdges.clear();
+        isExpanded.clear();
+        nextEdges.clear();
+        prevEdges.clear();
+        numExpandedNodes = 0;
     }
 
     const std::unique_ptr<MulticostID>& getEdgeCost(unsigned int edgeId) {
@@ -104,82 +174,293 @@ private:
     
     std::vector<std::unique_ptr<MulticostID>> edgeCosts;
 
+    // Indexed by edgeCostId * num_monoids + monoid
     std::vector<bool> computedCost;
 
-    std::unordered_map<uint32_t, S> nodes;
+    // Unique id of a state to its node id, the only lookup that is not an array index
+    FlatMap<uint32_t> nodeIndices;
+
+    // Indexed by node id
+    std::vector<S> nodes;
+    std::vector<bool> isExpanded;
+    std::vector<std::vector<MulticostEdge>> nextEdges;
+    std::vector<std::vector<MulticostEdge>> prevEdges;
+
+    // Next states of the node whose edges are computed
+    std::vector<S> batchStates;
+
+    unsigned int numExpandedNodes = 0;
+
+
+    uint32_t discoverNode(S& state) {
+        uint32_t uniqueId = state.getUniqueId();
+
+        const uint32_t* id = nodeIndices.find(uniqueId);
+        if (id != nullptr) return *id;
+
+        uint32_t newId = nodes.size();
+        nodeIndices[uniqueId] = newId;
+        nodes.push_back(state);
+        isExpanded.push_back(false);
+        nextEdges.emplace_back();
+        prevEdges.emplace_back();
+
+        return newId;
+    };
+
+
+    void addNextEdges(uint32_t frNodeId, unsigned int computeIndex) {
+        if constexpr (HasNextStatesBuffer<S>::value) {
+            S nextStates[S::MAX_NEXT_STATES];
+            unsigned int numNextStates = nodes[frNodeId].getNextStates(nextStates);
+            addNextEdges(frNodeId, nextStates, numNextStates, computeIndex);
+        } else {
+            std::vector<S> nextStates = nodes[frNodeId].getNextStates();
+            addNextEdges(frNodeId, nextStates.data(), nextStates.size(), computeIndex);
+        }
+    };
+
+
+    void addNextEdges(uint32_t frNodeId, S* nextStates, unsigned int numNextStates, unsigned int computeIndex) {
+        isExpanded[frNodeId] = true;
+        numExpandedNodes++;
+        nextEdges[frNodeId].resize(numNextStates);
+
+        unsigned int numMonoids = multicostArray->num_monoids();
+        uint32_t firstEdgeCostId = edgeCosts.size();
+        edgeCosts.resize(firstEdgeCostId + numNextStates);
+
+        // Compute edge cost monoid at computeIndex
+        if (computeIndex == ALL_MONOIDS) {
+            compute->computeCosts(nodes[frNodeId], nextStates, numNextStates, edgeCosts.data() + firstEdgeCostId);
+        } else {
+            compute->computeCosts(nodes[frNodeId], nextStates, numNextStates, edgeCosts.data() + firstEdgeCostId, computeIndex);
+        }
+
+        computedCost.resize(edgeCosts.size() * numMonoids, computeIndex == ALL_MONOIDS);
+
+        for (unsigned int i = 0; i < numNextStates; ++i) {
+            uint32_t edgeCostId = firstEdgeCostId + i;
+            uint32_t toNodeId = discoverNode(nextStates[i]);
+
+            if (computeIndex != ALL_MONOIDS) computedCost[edgeCostId * numMonoids + computeIndex] = true;
+
+            prevEdges[toNodeId].push_back({frNodeId, edgeCostId});
+
+            nextEdges[frNodeId][i] = {toNodeId, edgeCostId};
+        }
+    };
+
+};
+
+
+
+/***
+    Static Multicost Graph
+    Explicit graph whose edges are added with their complete multicosts.
+    Edges added after a checkpoint can be removed again, which lets queries
+    connect temporary nodes and roll them back afterwards.
+    Node ids are chosen by the caller and must be dense, see IMulticostGraph.
+*/
+class StaticMulticostGraph : public IMulticostGraph {
+public:
+    void addEdge(uint32_t frNodeId, uint32_t toNodeId, std::unique_ptr<MulticostID> cost) {
+        uint32_t edgeCostId = edgeCosts.size();
+
+        edgeCosts.push_back(std::move(cost));
+        edgeNodes.push_back({frNodeId, toNodeId});
+        mapNextEdges[frNodeId].push_back({toNodeId, edgeCostId});
+        mapPrevEdges[toNodeId].push_back({frNodeId, edgeCostId});
+    };
+
+    unsigned int getNumEdges() const {
+        return edgeNodes.size();
+    };
+
+    // Removes every edge added after the graph had numEdges edges
+    void truncate(unsigned int numEdges) {
+        while (edgeNodes.size() > numEdges) {
+            const std::pair<uint32_t, uint32_t>& nodes = edgeNodes.back();
+            mapNextEdges[nodes.first].pop_back();
+            mapPrevEdges[nodes.second].pop_back();
+            edgeCosts.pop_back();
+            edgeNodes.pop_back();
+        }
+    };
 
-    std::unordered_map<uint32_t, std::vector<MulticostEdge>> mapNextEdges;
-    std::unordered_map<uint32_t, std::vector<MulticostEdge>> mapPrevEdges;
+    void clear() {
+        edgeCosts.clear();
+        edgeNodes.clear();
+        mapNextEdges.clear();
+        mapPrevEdges.clear();
+    };
+
+    // Costs are complete when added
+    void computeEdgesAtIndex(uint32_t id, unsigned int computeIndex) override { };
+
+    std::vector<MulticostEdge>& getNextEdges(uint32_t id, unsigned int computeIndex) override {
+        return mapNextEdges[id];
+    };
 
+    std::vector<MulticostEdge>& getPrevEdges(uint32_t id, unsigned int computeIndex) override {
+        return mapPrevEdges[id];
+    };
 
-    void addNextEdges(S currentState, unsigned int computeIndex) {
-        std::vector<S> nextStates = currentState.getNextStates();
-        uint32_t frNodeId = currentState.getUniqueId();
-        mapNextEdges[frNodeId] = std::vector<MulticostEdge>(nextStates.size());
+    const std::unique_ptr<MulticostID>& getEdgeCost(unsigned int edgeId) override {
+        return edgeCosts[edgeId];
+    };
 
-        for (unsigned int i = 0; i < nextStates.size(); ++i) {
-            S nextState = nextStates[i];
-            uint32_t toNodeId = nextState.getUniqueId();
+private:
+    std::vector<std::unique_ptr<MulticostID>> edgeCosts;
+    // Source and target of every edge, indexed by edge cost id
+    std::vector<std::pair<uint32_t, uint32_t>> edgeNodes;
 
-            nodes[toNodeId] = nextState;
-            
-            std::unique_ptr<MulticostID> costId = compute->computeCost(currentState, nextState, computeIndex);
-            
-            edgeCosts.push_back(std::move(costId));
+    FlatMap<std::vector<MulticostEdge>> mapNextEdges;
+    FlatMap<std::vector<MulticostEdge>> mapPrevEdges;
+};
 
-            MulticostEdge edge;
-            edge.edgeCostId = edgeCosts.size() - 1;
-            edge.frNodeId = frNodeId;
-            edge.toNodeId = toNodeId;
-            edge.computedCostIndexBegin = computedCost.size();
 
-            // Compute edge cost monoid at computeIndex
-            for (unsigned k = 0; k < multicostArray->num_monoids(); ++k) computedCost.push_back(false);
-            computedCost[edge.computedCostIndexBegin + computeIndex] = true;
 
-            
-            if (mapPrevEdges.find(toNodeId) == mapPrevEdges.end()) mapPrevEdges[toNodeId] = std::vector<MulticostEdge>();
-            mapPrevEdges[toNodeId].push_back(edge);
+/***
+    Node Edge Lists
+    Edge lists indexed by dense node id. clear() only bumps the epoch, a list is
+    emptied when first touched in the new epoch so its capacity is reused.
+*/
+class NodeEdgeLists {
+public:
+    std::vector<MulticostEdge>& at(uint32_t id) {
+        if (id >= lists.size()) {
+            size_t newSize = std::max<size_t>(lists.size() * 2, static_cast<size_t>(id) + 1);
+            lists.resize(newSize);
+            stamps.resize(newSize, 0);
+        }
+        if (stamps[id] != epoch) {
+            lists[id].clear();
+            stamps[id] = epoch;
+        }
+        return lists[id];
+    };
 
-            mapNextEdges[frNodeId][i] = edge;
+    void clear() {
+        epoch += 1;
+        if (epoch == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            epoch = 1;
         }
     };
 
+private:
+    std::vector<std::vector<MulticostEdge>> lists;
+    std::vector<uint32_t> stamps;
+    uint32_t epoch = 1;
 };
 
 
+
+/***
+    Node Weights
+    Multicost weights indexed by dense node id, cleared with an epoch like NodeEdgeLists.
+    clear() releases the multicosts of the last query instead of holding them until their
+    nodes are written again, so a repeated query reuses the ids it freed.
+*/
+class NodeWeights {
+public:
+    bool contains(uint32_t id) const {
+        return id < stamps.size() && stamps[id] == epoch;
+    };
+
+    // Null for nodes without a weight
+    const std::unique_ptr<MulticostID>& at(uint32_t id) const {
+        return contains(id) ? weights[id] : noWeight;
+    };
+
+    void set(uint32_t id, std::unique_ptr<MulticostID> weight) {
+        if (id >= weights.size()) {
+            size_t newSize = std::max<size_t>(weights.size() * 2, static_cast<size_t>(id) + 1);
+            weights.resize(newSize);
+            stamps.resize(newSize, 0);
+        }
+        if (stamps[id] != epoch) setIds.push_back(id);
+        weights[id] = std::move(weight);
+        stamps[id] = epoch;
+    };
+
+    // Releases the weights set since the last clear, so their ids go back to the pool
+    // before the next query allocates its own, linear in the number of weights set
+    void clear() {
+        for (uint32_t id : setIds) weights[id].reset();
+        setIds.clear();
+
+        epoch += 1;
+        if (epoch == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            epoch = 1;
+        }
+    };
+
+private:
+    std::vector<std::unique_ptr<MulticostID>> weights;
+    std::vector<uint32_t> stamps;
+    std::vector<uint32_t> setIds;
+    uint32_t epoch = 1;
+
+    const std::unique_ptr<MulticostID> noWeight;
+};
+
+
+
+/***
+    Optimal Subgraph
+    Weights, propagation (temp) edges and optimal edges of the IDP iterations.
+    Storage is indexed by node id and kept between queries, reset() starts a new query in O(1).
+*/
 class OptimalSubgraph {
 public:
-    OptimalSubgraph(IMulticostGraph& graph) : multicostGraph(graph) {
+    OptimalSubgraph() : multicostGraph(nullptr) {
+        isInitial = true;
+        numBranchingNodes = 0;
+    };
+
+    OptimalSubgraph(IMulticostGraph& graph) : multicostGraph(&graph) {
+        isInitial = true;
+        numBranchingNodes = 0;
+    };
+
+    void reset(IMulticostGraph& graph) {
+        multicostGraph = &graph;
         isInitial = true;
+        clearOptimalEdges();
+        clearPropagationEdges();
+        clearWeights();
     };
 
-    const std::vector<MulticostEdge>& getOptimalEdges() {
+    // Source and target of every optimal edge, one pair after the other
+    const std::vector<uint32_t>& getOptimalEdges() {
         return optimalEdges;
     }
     
     const std::vector<MulticostEdge>& getOptimalNextEdges(uint32_t id) {
-        return optimalNextEdges[id];
+        return optimalNextEdges.at(id);
     };
 
 
     const std::vector<MulticostEdge>& getOptimalPrevEdges(uint32_t id) {
-        return optimalPrevEdges[id];
+        return optimalPrevEdges.at(id);
     };
 
 
     const std::unique_ptr<MulticostID>& getEdgeCost(unsigned int edgeId) {
-        return multicostGraph.getEdgeCost(edgeId);
+        return multicostGraph->getEdgeCost(edgeId);
     }
 
 
     std::vector<MulticostEdge>& getOptimalNextEdges(uint32_t id, unsigned int computeIndex) {
         if (isInitial) {
-            return multicostGraph.getNextEdges(id, computeIndex);
+            return multicostGraph->getNextEdges(id, computeIndex);
         } else {
             // Make sure that the monoid at computeIndex is computed
-            multicostGraph.computeEdgesAtIndex(id, computeIndex);
-            return optimalNextEdges[id];
+            multicostGraph->computeEdgesAtIndex(id, computeIndex);
+            return optimalNextEdges.at(id);
         }
     };
 
@@ -190,50 +471,51 @@ public:
         // id does not exist in backward edges
 
         if (isInitial) {
-            return multicostGraph.getPrevEdges(id, computeIndex);
+            return multicostGraph->getPrevEdges(id, computeIndex);
         } else {
             // assume that the backward edges computation on computeIndex are computed in the getNextEdges
             // multicostGraph.computeEdgesAtIndex(id, computeIndex);
-            return optimalPrevEdges[id];
+            return optimalPrevEdges.at(id);
         }
     };
 
 
-    void addTempNextEdge(MulticostEdge edge) {
-        uint32_t frNodeId = edge.frNodeId;
-        if (tempNextEdges.find(frNodeId) == tempNextEdges.end()) tempNextEdges[frNodeId] = std::vector<MulticostEdge>();
-        tempNextEdges[frNodeId].push_back(edge);
+    // nextEdge is a next edge of frNodeId
+    void addTempNextEdge(uint32_t frNodeId, MulticostEdge nextEdge) {
+        tempNextEdges.at(frNodeId).push_back(nextEdge);
     };
     
 
-    void addTempPrevEdge(MulticostEdge edge) {
-        uint32_t toNodeId = edge.toNodeId;
-        if (tempPrevEdges.find(toNodeId) == tempPrevEdges.end()) tempPrevEdges[toNodeId] = std::vector<MulticostEdge>();
-        tempPrevEdges[toNodeId].push_back(edge);
+    // prevEdge is a prev edge of toNodeId
+    void addTempPrevEdge(uint32_t toNodeId, MulticostEdge prevEdge) {
+        tempPrevEdges.at(toNodeId).push_back(prevEdge);
     };
 
 
-    void addOptimalEdge(MulticostEdge edge) {
-        if (optimalNextEdges.find(edge.frNodeId) == optimalNextEdges.end()) optimalNextEdges[edge.frNodeId] = std::vector<MulticostEdge>();
-        if (optimalPrevEdges.find(edge.toNodeId) == optimalPrevEdges.end()) optimalPrevEdges[edge.toNodeId] = std::vector<MulticostEdge>();
+    // nextEdge is a next edge of frNodeId
+    void addOptimalEdge(uint32_t frNodeId, MulticostEdge nextEdge) {
+        std::vector<MulticostEdge>& nextEdges = optimalNextEdges.at(frNodeId);
+        nextEdges.push_back(nextEdge);
+        optimalPrevEdges.at(nextEdge.nodeId).push_back({frNodeId, nextEdge.edgeCostId});
+        optimalEdges.push_back(frNodeId);
+        optimalEdges.push_back(nextEdge.nodeId);
 
-        optimalNextEdges[edge.frNodeId].push_back(edge);
-        optimalPrevEdges[edge.toNodeId].push_back(edge);
-        optimalEdges.push_back(edge);
+        if (nextEdges.size() == 2) numBranchingNodes++;
     };
 
     void setNextWeight(uint32_t id, std::unique_ptr<MulticostID> cost) {
-        nextWeights[id] = std::move(cost);
+        nextWeights.set(id, std::move(cost));
     };
 
     void setPrevWeight(uint32_t id, std::unique_ptr<MulticostID> cost) {
-        prevWeights[id] = std::move(cost);
+        prevWeights.set(id, std::move(cost));
     };
 
     void clearOptimalEdges() {
         optimalNextEdges.clear();
         optimalPrevEdges.clear();
         optimalEdges.clear();
+        numBranchingNodes = 0;
     };
 
     void clearPropagationEdges() {
@@ -247,51 +529,58 @@ public:
     };
 
     bool isNextWeightInf(uint32_t frNodeId) {
-        return nextWeights.find(frNodeId) == nextWeights.end();
+        return !nextWeights.contains(frNodeId);
     }
 
     const std::unique_ptr<MulticostID>& getNextWeight(uint32_t frNodeId) {
-        return nextWeights[frNodeId];
+        return nextWeights.at(frNodeId);
     }
 
     bool isPrevWeightInf(uint32_t toNodeId) {
-        return prevWeights.find(toNodeId) == prevWeights.end();
+        return !prevWeights.contains(toNodeId);
     }
 
     const std::unique_ptr<MulticostID>& getPrevWeight(uint32_t toNodeId) {
-        return prevWeights[toNodeId];
+        return prevWeights.at(toNodeId);
     }
 
     bool isGraphExists() {
-        return optimalNextEdges.size();
+        return optimalEdges.size();
+    };
+
+    // No node has two optimal edges out, later monoids can not change a single path
+    bool isSinglePath() {
+        return isGraphExists() && numBranchingNodes == 0;
     };
 
     void notInitial() {
         isInitial = false;
     }
 
-    std::unordered_map<uint32_t, std::vector<MulticostEdge>>& getTempNextEdges() {
-        return tempNextEdges;
+    std::vector<MulticostEdge>& getTempNextEdges(uint32_t id) {
+        return tempNextEdges.at(id);
     }
 
-    std::unordered_map<uint32_t, std::vector<MulticostEdge>>& getTempPrevEdges() {
-        return tempPrevEdges;
+    std::vector<MulticostEdge>& getTempPrevEdges(uint32_t id) {
+        return tempPrevEdges.at(id);
     }
 
 private:
     bool isInitial;
-    IMulticostGraph& multicostGraph;
+    IMulticostGraph* multicostGraph;
+
+    unsigned int numBranchingNodes;
 
-    std::vector<MulticostEdge> optimalEdges;
+    std::vector<uint32_t> optimalEdges;
 
-    std::unordered_map<uint32_t, std::vector<MulticostEdge>> optimalNextEdges;
-    std::unordered_map<uint32_t, std::vector<MulticostEdge>> optimalPrevEdges;
+    NodeEdgeLists optimalNextEdges;
+    NodeEdgeLists optimalPrevEdges;
 
-    std::unordered_map<uint32_t, std::vector<MulticostEdge>> tempNextEdges;
-    std::unordered_map<uint32_t, std::vector<MulticostEdge>> tempPrevEdges;
+    NodeEdgeLists tempNextEdges;
+    NodeEdgeLists tempPrevEdges;
 
-    std::unordered_map<uint32_t, std::unique_ptr<MulticostID>> nextWeights;
-    std::unordered_map<uint32_t, std::unique_ptr<MulticostID>> prevWeights;
+    NodeWeights nextWeights;
+    NodeWeights prevWeights;
 
 };
 
@@ -0,0 +1,21 @@
+#ifndef MULTICOST_HEURISTIC_H
+#define MULTICOST_HEURISTIC_H
+
+#include <cstdint>
+#include <memory>
+#include "multicost_array.hpp"
+
+
+/***
+    Multicost Heuristic
+    Lower bounds on the cost of each monoid between two nodes, used for goal directed search.
+    The bounds must be consistent: for every edge (u, v) and target t the bound of (u, t)
+    is at most the edge cost composed with the bound of (v, t), and likewise for sources.
+*/
+class IMulticostHeuristic {
+public:
+    // Writes a lower bound of the monoid at index on the cost from frNodeId to toNodeId into res
+    virtual void lowerBound(uint32_t frNodeId, uint32_t toNodeId, unsigned int index, const std::unique_ptr<MulticostID>& res) = 0;
+};
+
+#endif
\ No newline at end of file
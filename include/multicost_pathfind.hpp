@@ -4,11 +4,31 @@
 #include <cstdint>
 #include <vector>
 #include "multicost_graph.hpp"
+#include "query_cancellation.hpp"
+#include "query_workspace.hpp"
 
 class IMulticostPathfind {
 public:
     virtual std::vector<uint32_t> getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end) = 0;
     virtual std::vector<uint32_t> getOptimalEdges(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end) = 0;
+
+    // Anytime variants: stop when cancellation fires and return the best result found so far
+    virtual std::vector<uint32_t> getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryCancellation& cancellation, QueryProgress& progress) = 0;
+    virtual std::vector<uint32_t> getOptimalEdges(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryCancellation& cancellation, QueryProgress& progress) = 0;
+
+    // Writes the node ids of a single optimal path into path, reusing its capacity
+    virtual void getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, std::vector<uint32_t>& path, QueryCancellation& cancellation, QueryProgress& progress) = 0;
+
+    // Also runs on caller owned scratch buffers, a warm workspace lets repeated queries skip allocation
+    virtual void getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, std::vector<uint32_t>& path, QueryWorkspace& workspace, QueryCancellation& cancellation, QueryProgress& progress) = 0;
+};
+
+
+// Pathfinds and heuristics with an offline stage over the whole graph reachable from the seed nodes
+// The graph must not be cleared between preprocess and the queries
+class IMulticostPreprocess {
+public:
+    virtual void preprocess(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, const std::vector<uint32_t>& seeds) = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef QUERY_CANCELLATION_H
+#define QUERY_CANCELLATION_H
+
+#include <atomic>
+#include <chrono>
+
+
+/***
+    Query Cancellation
+    Polled from inside the search loops to stop a query once its deadline passes
+    or once another thread raises the cancel flag.
+    The clock is only read every CHECK_INTERVAL polls to keep the check cheap.
+*/
+class QueryCancellation {
+public:
+    // Never cancels
+    QueryCancellation() :
+        hasDeadline(false), cancelFlag(nullptr), numPolls(0), cancelled(false) {};
+
+    QueryCancellation(std::chrono::steady_clock::time_point deadline) :
+        deadline(deadline), hasDeadline(true), cancelFlag(nullptr), numPolls(0), cancelled(false) {};
+
+    QueryCancellation(const std::atomic<bool>& cancelFlag) :
+        hasDeadline(false), cancelFlag(&cancelFlag), numPolls(0), cancelled(false) {};
+
+    QueryCancellation(std::chrono::steady_clock::time_point deadline, const std::atomic<bool>& cancelFlag) :
+        deadline(deadline), hasDeadline(true), cancelFlag(&cancelFlag), numPolls(0), cancelled(false) {};
+
+
+    bool isCancelled() {
+        if (cancelled) return true;
+
+        if (cancelFlag != nullptr && cancelFlag->load(std::memory_order_relaxed)) {
+            cancelled = true;
+        } else if (hasDeadline && numPolls++ % CHECK_INTERVAL == 0) {
+            cancelled = std::chrono::steady_clock::now() >= deadline;
+        }
+
+        return cancelled;
+    };
+
+private:
+    static constexpr unsigned int CHECK_INTERVAL = 64;
+
+    std::chrono::steady_clock::time_point deadline;
+    bool hasDeadline;
+    const std::atomic<bool>* cancelFlag;
+
+    unsigned int numPolls;
+    bool cancelled;
+};
+
+
+// How far an anytime query got before it returned
+struct QueryProgress {
+    // The returned result is optimal on the monoids [0, numMonoidsOptimal)
+    unsigned int numMonoidsOptimal = 0;
+    // True when every monoid was processed
+    bool isComplete = false;
+    // Monoid iterations skipped once the optimal subgraph collapsed to a single path
+    unsigned int numMonoidsSkipped = 0;
+};
+
+#endif
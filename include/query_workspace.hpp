@@ -0,0 +1,150 @@
+#ifndef QUERY_WORKSPACE_H
+#define QUERY_WORKSPACE_H
+
+#include "heap.hpp"
+#include "multicost_array.hpp"
+#include "multicost_graph.hpp"
+#include "visited_set.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+// Heap item of the searches, priority is the weight composed with the heuristic bound
+struct SearchCost {
+    std::unique_ptr<MulticostID> priority;
+    std::unique_ptr<MulticostID> weight;
+
+    const std::unique_ptr<MulticostID>& key() const {
+        return priority ? priority : weight;
+    };
+};
+
+
+// Scratch buffers of the delta stepping passes, node ids index the per node arrays
+// The entries of a node are reset the first time a pass touches it, which known records
+struct DeltaSteppingBuffers {
+    struct RelaxEdge {
+        MulticostEdge edge;
+        uint32_t frNode;
+        uint32_t toNode;
+        double cost;
+    };
+
+    struct Request {
+        uint32_t toNode;
+        double distance;
+        unsigned int edgeIndex;
+    };
+
+    VisitedSet known;
+    std::vector<double> distances;
+    std::vector<unsigned int> predecessorEdges;
+    std::vector<bool> expanded;
+    std::vector<bool> inFrontier;
+    std::vector<bool> inSettled;
+
+    // Edges of expanded node n are edges[edgesBegin[n], edgesEnd[n])
+    std::vector<RelaxEdge> edges;
+    std::vector<unsigned int> edgesBegin;
+    std::vector<unsigned int> edgesEnd;
+
+    // Ring of buckets, its size is kept for the next passes
+    std::vector<std::vector<uint32_t>> buckets;
+    // Requests gathered by task t for partition p are requests[t * numTasks + p]
+    std::vector<std::vector<Request>> requests;
+    std::vector<std::vector<uint32_t>> improvedNodes;
+
+    std::vector<uint32_t> expandOrder;
+    std::vector<uint32_t> bucketNodes;
+    std::vector<uint32_t> frontier;
+    std::vector<uint32_t> settled;
+    std::vector<uint32_t> chain;
+    // Moved into the optimal subgraph at the end of each pass, so every entry is null between passes
+    std::vector<std::unique_ptr<MulticostID>> weights;
+};
+
+
+/***
+    Query Workspace
+    Scratch buffers reused between queries: the search heap, closed set, bfs queue,
+    optimal subgraph, predecessors, delta stepping buffers and an output path. Every buffer keeps its capacity
+    and is reset in O(1) or in the size of the last query, which also returns the multicosts
+    it held to the pool. Once warm, a query on an explored graph does not allocate.
+    A workspace must only be used by one query at a time, IteratedDijkstraPropagation
+    keeps one per thread for the calls that do not pass their own.
+*/
+class QueryWorkspace {
+public:
+    QueryWorkspace() :
+        heap([this](const SearchCost& a, const SearchCost& b) { return !(compareKeys(a, b) < 0); }) {};
+
+    // The workspace is captured by its heap order
+    QueryWorkspace(const QueryWorkspace&) = delete;
+    QueryWorkspace& operator=(const QueryWorkspace&) = delete;
+
+    // Empty heap ordered on the monoid at monoidIndex, or on the whole multicost for IMulticostGraph::ALL_MONOIDS
+    Heap<SearchCost>& getHeap(IMulticostArray& multicostArray, unsigned int monoidIndex) {
+        heapArray = &multicostArray;
+        heapMonoidIndex = monoidIndex;
+        heap.clear();
+        return heap;
+    };
+
+    // Closed set of the current search, cleared by each search before use
+    VisitedSet& getClosed() {
+        return closed;
+    };
+
+    // Empty bfs queue, consumed with a read index so its capacity is kept
+    std::vector<uint32_t>& getQueue() {
+        queue.clear();
+        return queue;
+    };
+
+    // Optimal subgraph of the current query on graph, the previous query's subgraph is dropped
+    OptimalSubgraph& getOptimalSubgraph(IMulticostGraph& graph) {
+        optimalSubgraph.reset(graph);
+        return optimalSubgraph;
+    };
+
+    // Buffers of the delta stepping passes, each pass resets the parts it uses
+    DeltaSteppingBuffers& getDeltaSteppingBuffers() {
+        return deltaStepping;
+    };
+
+    // Output buffer for callers that do not keep their own
+    std::vector<uint32_t>& getPath() {
+        return path;
+    };
+
+    // Predecessor of a node in the last optimal edge bfs, only valid for nodes visited by it
+    uint32_t getPredecessor(uint32_t id) const {
+        return predecessors[id];
+    };
+
+    void setPredecessor(uint32_t id, uint32_t predecessorId) {
+        if (id >= predecessors.size()) predecessors.resize(std::max<size_t>(predecessors.size() * 2, static_cast<size_t>(id) + 1));
+        predecessors[id] = predecessorId;
+    };
+
+private:
+    IMulticostArray* heapArray = nullptr;
+    unsigned int heapMonoidIndex = 0;
+    Heap<SearchCost> heap;
+
+    VisitedSet closed;
+    std::vector<uint32_t> queue;
+    OptimalSubgraph optimalSubgraph;
+    DeltaSteppingBuffers deltaStepping;
+    std::vector<uint32_t> path;
+    std::vector<uint32_t> predecessors;
+
+    int compareKeys(const SearchCost& a, const SearchCost& b) const {
+        if (heapMonoidIndex == IMulticostGraph::ALL_MONOIDS) return heapArray->compare(a.key(), b.key());
+        return heapArray->compare(a.key(), b.key(), heapMonoidIndex);
+    };
+};
+
+#endif
@@ -4,7 +4,6 @@
 #include <array>
 #include <cstdint>
 #include <memory>
-#include <unordered_map>
 #include <vector>
 #include "multicost.hpp"
 #include "multicost_array.hpp"
@@ -22,9 +21,10 @@ public:
     SingleOptimalPathFinder(std::tuple<Ts...> identity, 
         std::tuple<std::function<int(Ts a, Ts b)>...> compares,
         std::tuple<std::function<Ts(Ts a, Ts b)>...> ops,
-        std::tuple<std::function<Ts(S a, S b)>...> computes
+        std::tuple<std::function<Ts(S a, S b)>...> computes,
+        bool isLexicographic = false
     ) {
-        PolyMulticostProps<Ts...> props(identity, compares, ops);
+        PolyMulticostProps<Ts...> props(identity, compares, ops, isLexicographic);
         std::shared_ptr<PolyMulticostArray<Ts...>> polyArray = std::make_shared<PolyMulticostArray<Ts...>>(props);
         std::shared_ptr<IMulticostCompute<S>> compute = std::make_shared<PolyMulticostCompute<S, Ts...>>(polyArray, computes);
 
@@ -38,10 +38,11 @@ public:
     SingleOptimalPathFinder(std::array<T, SIZE> identity, 
         std::array<std::function<int(T a, T b)>, SIZE> compares,
         std::array<std::function<T(T a, T b)>, SIZE> ops,
-        std::array<std::function<T(S& a, S& b)>, SIZE> computes
+        std::array<std::function<T(S& a, S& b)>, SIZE> computes,
+        bool isLexicographic = false
     ) {
 
-        MonoMulticostProps<T, SIZE> props(identity, compares, ops);
+        MonoMulticostProps<T, SIZE> props(identity, compares, ops, isLexicographic);
         std::shared_ptr<MonoMulticostArray<T, SIZE>> monoArray = std::make_shared<MonoMulticostArray<T, SIZE>>(props);
         std::shared_ptr<IMulticostCompute<S>> compute = std::make_shared<MonoMulticostCompute<S, T, SIZE>>(monoArray, computes);
 
@@ -51,49 +52,141 @@ public:
 
     };
 
+
+    // Plans with a compute built by the caller, such as a CachedMulticostCompute
+    SingleOptimalPathFinder(std::shared_ptr<IMulticostArray> multicostArray, std::shared_ptr<IMulticostCompute<S>> compute) : multicostArray(multicostArray) {
+        graph = std::make_unique<LazyMulticostGraph<S>>(multicostArray, compute);
+    };
+
+
+    // Each monoid computes the costs of all the next states of a state in one call
+    template<typename T, size_t SIZE>
+    SingleOptimalPathFinder(std::array<T, SIZE> identity,
+        std::array<std::function<int(T a, T b)>, SIZE> compares,
+        std::array<std::function<T(T a, T b)>, SIZE> ops,
+        std::array<std::function<void(S& a, S* bs, unsigned int numStates, T* costs)>, SIZE> batchComputes,
+        bool isLexicographic = false
+    ) {
+        MonoMulticostProps<T, SIZE> props(identity, compares, ops, isLexicographic);
+        std::shared_ptr<MonoMulticostArray<T, SIZE>> monoArray = std::make_shared<MonoMulticostArray<T, SIZE>>(props);
+        std::shared_ptr<IMulticostCompute<S>> compute = std::make_shared<MonoMulticostCompute<S, T, SIZE>>(monoArray, batchComputes);
+
+        multicostArray = monoArray;
+
+        graph = std::make_unique<LazyMulticostGraph<S>>(multicostArray, compute);
+    };
+
     
     // Translating node ids into path of states
     std::vector<S> getOptimalPath(IMulticostPathfind& algorithm, S start, S end) {
-        graph->addNode(start);
+        uint32_t startId = graph->addNode(start);
+        uint32_t endId = graph->addNode(end);
         
-        std::vector<uint32_t> rawPath = algorithm.getOptimalPath(*graph, multicostArray, start.getUniqueId(), end.getUniqueId());
+        std::vector<uint32_t> rawPath = algorithm.getOptimalPath(*graph, multicostArray, startId, endId);
         std::vector<S> statesPath(rawPath.size());
 
-        const std::unordered_map<uint32_t, S>& states = graph->getNodes();
+        for (unsigned int i = 0; i < rawPath.size(); ++i) {
+            statesPath[i] = graph->getNode(rawPath[i]); 
+        }
+        
+        return statesPath;
+    };
+
+
+
+    // Anytime variant, progress reports on how many monoids the path is optimal
+    std::vector<S> getOptimalPath(IMulticostPathfind& algorithm, S start, S end, QueryCancellation& cancellation, QueryProgress& progress) {
+        uint32_t startId = graph->addNode(start);
+        uint32_t endId = graph->addNode(end);
         
+        std::vector<uint32_t> rawPath = algorithm.getOptimalPath(*graph, multicostArray, startId, endId, cancellation, progress);
+        std::vector<S> statesPath(rawPath.size());
+
         for (unsigned int i = 0; i < rawPath.size(); ++i) {
-            statesPath[i] = states.at(rawPath[i]); 
+            statesPath[i] = graph->getNode(rawPath[i]); 
         }
         
         return statesPath;
     };
 
+
+
+    // Writes the path into caller provided buffers, rawPath holds the unique ids of the states
+    void getOptimalPath(IMulticostPathfind& algorithm, S start, S end, std::vector<uint32_t>& rawPath, std::vector<S>& statesPath, QueryCancellation& cancellation, QueryProgress& progress) {
+        uint32_t startId = graph->addNode(start);
+        uint32_t endId = graph->addNode(end);
+
+        algorithm.getOptimalPath(*graph, multicostArray, startId, endId, rawPath, cancellation, progress);
+        toStates(rawPath, statesPath);
+    };
+
+
+
+    // Same with caller owned scratch buffers, the workspace must not be shared between threads
+    void getOptimalPath(IMulticostPathfind& algorithm, S start, S end, std::vector<uint32_t>& rawPath, std::vector<S>& statesPath, QueryWorkspace& workspace, QueryCancellation& cancellation, QueryProgress& progress) {
+        uint32_t startId = graph->addNode(start);
+        uint32_t endId = graph->addNode(end);
+
+        algorithm.getOptimalPath(*graph, multicostArray, startId, endId, rawPath, workspace, cancellation, progress);
+        toStates(rawPath, statesPath);
+    };
+
     
     
     std::vector<S> getOptimalEdges(IMulticostPathfind& algorithm, S start, S end) {
-        graph->addNode(start);
+        uint32_t startId = graph->addNode(start);
+        uint32_t endId = graph->addNode(end);
         
-        std::vector<uint32_t> rawEdges = algorithm.getOptimalEdges(*graph, multicostArray, start.getUniqueId(), end.getUniqueId());
+        std::vector<uint32_t> rawEdges = algorithm.getOptimalEdges(*graph, multicostArray, startId, endId);
         std::vector<S> statesPath(rawEdges.size());
 
-        const std::unordered_map<uint32_t, S>& states = graph->getNodes();
-        
         for (unsigned int i = 0; i < rawEdges.size(); ++i) {
-            statesPath[i] = states.at(rawEdges[i]); 
+            statesPath[i] = graph->getNode(rawEdges[i]); 
         }
         
         return statesPath;
     };
 
+    // Runs the offline stage of algorithm on every state reachable from seeds
+    // Clearing the graph afterwards invalidates the preprocessing
+    void preprocess(IMulticostPreprocess& algorithm, std::vector<S> seeds) {
+        std::vector<uint32_t> seedIds(seeds.size());
+
+        for (unsigned int i = 0; i < seeds.size(); ++i) {
+            seedIds[i] = graph->addNode(seeds[i]);
+        }
+
+        algorithm.preprocess(*graph, multicostArray, seedIds);
+    };
+
     // Clear all cached multicost computes
     void clearGraph() {
         graph->clear();
     }
 
+    // States stored in the graph, expanded or only discovered
+    uint32_t getNumNodes() const {
+        return graph->getNumNodes();
+    };
+
+    unsigned int getNumExpandedNodes() const {
+        return graph->getNumExpandedNodes();
+    };
+
 private:
     std::unique_ptr<LazyMulticostGraph<S>> graph;
     std::shared_ptr<IMulticostArray> multicostArray;
     std::unique_ptr<IMulticostCompute<S>> multicostCompute;
+
+    // Translates the node ids of the graph in rawPath into states and unique ids
+    void toStates(std::vector<uint32_t>& rawPath, std::vector<S>& statesPath) {
+        statesPath.resize(rawPath.size());
+
+        for (unsigned int i = 0; i < rawPath.size(); ++i) {
+            statesPath[i] = graph->getNode(rawPath[i]);
+            rawPath[i] = statesPath[i].getUniqueId();
+        }
+    };
 };
 
 
@@ -0,0 +1,57 @@
+#ifndef TERRAIN_GRID_STATE_H
+#define TERRAIN_GRID_STATE_H
+
+#include <cstdint>
+#include <vector>
+#include "grid_map.hpp"
+
+// Moves of a TerrainGridState, SIXTEEN adds the knight moves to EIGHT
+enum class GridConnectivity {
+    FOUR = 4,
+    EIGHT = 8,
+    SIXTEEN = 16
+};
+
+
+/***
+    Terrain Grid State
+    Cell of a GridMap with diagonal and knight moves. A move may not cut corners: every cell
+    its segment crosses must be free, both side cells for a diagonal and the two cells passed
+    for a knight move. A move costs its euclidean length times the mean terrain weight of its
+    ends, in fixed point units of 1 / COST_SCALE so path costs add up exactly in IDP.
+    The map must outlive its states.
+*/
+class TerrainGridState {
+public:
+    int x;
+    int y;
+
+    static constexpr unsigned int MAX_NEXT_STATES = 16;
+    static constexpr int COST_SCALE = 1000;
+
+    TerrainGridState();
+    TerrainGridState(const GridMap& map, int x, int y, GridConnectivity connectivity = GridConnectivity::EIGHT);
+    uint32_t getUniqueId();
+    std::vector<TerrainGridState> getNextStates();
+    unsigned int getNextStates(TerrainGridState* nextStates);
+
+    int numberOfNearbyObstacles();
+
+    // Cost of the move to a next state
+    int getMoveCost(const TerrainGridState& toState) const;
+
+    // Costs of the moves to numNextStates next states, in one branch free loop over the set
+    void getMoveCosts(const TerrainGridState* nextStates, unsigned int numNextStates, int* costs) const;
+
+    const GridMap* getMap() const;
+
+private:
+    const GridMap* map;
+    uint32_t linearPos;
+    GridConnectivity connectivity;
+
+    bool isFree(int cellX, int cellY) const;
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#ifndef TILED_GRID_MAP_H
+#define TILED_GRID_MAP_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "flat_map.hpp"
+#include "grid_map.hpp"
+
+struct TiledGridStats {
+    // Chunks read by the planning thread when a cell was missing
+    unsigned int numChunkLoads = 0;
+    // Chunks the background reader had ready when they were first needed
+    unsigned int numPrefetchHits = 0;
+    unsigned int numEvictions = 0;
+};
+
+
+/***
+    Tiled Grid Map
+    Occupancy of a grid too large for memory, stored on disk in square chunks of bit packed
+    cells and paged in when a cell is read. At most maxResidentChunks chunks stay in memory,
+    counting the chunks prefetched but not used yet: a quarter of the budget holds prefetched
+    chunks, the rest holds the chunks in use and evicts the least recently used one to make room.
+    prefetch queues a chunk for a background reader, so a search can request the chunks ahead
+    of its frontier before it reaches them. When the prefetched chunks fill their share the
+    oldest one is dropped, the search has moved on from it. Only one thread may read cells and
+    prefetch, the reader never touches the resident chunks. Cells outside the grid are obstacles.
+    Grids have at most 2^32 cells, so TiledGridState ids fit in 32 bits.
+*/
+class TiledGridMap {
+public:
+    TiledGridMap();
+    ~TiledGridMap();
+
+    TiledGridMap(const TiledGridMap&) = delete;
+    TiledGridMap& operator=(const TiledGridMap&) = delete;
+
+    // Returns false when the file is missing, not a tiled map, or has more than 2^32 cells
+    bool open(const std::string& path, unsigned int maxResidentChunks);
+
+    // Writes map as a tiled map file, chunks of chunkSide cells per side
+    static bool writeTiles(const std::string& path, const GridMap& map, int chunkSide);
+
+    int getWidth() const {
+        return width;
+    };
+
+    int getHeight() const {
+        return height;
+    };
+
+    int getChunkSide() const {
+        return chunkSide;
+    };
+
+    unsigned int getNumResidentChunks() const {
+        return slots.size();
+    };
+
+    // Prefetched chunks waiting for their first use
+    unsigned int getNumReadyChunks();
+
+    // Blocks until the reader has handled every queued prefetch
+    void waitForPrefetches();
+
+    const TiledGridStats& getStats() const {
+        return stats;
+    };
+
+    // Pages in the chunk of the cell when it is not resident
+    bool isObstacle(int x, int y) {
+        if (x < 0 || y < 0 || x >= width || y >= height) return true;
+
+        uint32_t chunkId = (y / chunkSide) * numChunksX + x / chunkSide;
+        if (chunkId != lastChunkId) useChunk(chunkId);
+
+        uint32_t bit = (y % chunkSide) * chunkSide + x % chunkSide;
+        return (slots[lastSlot].words[bit / 64] >> (bit % 64)) & 1;
+    };
+
+    // Queues the chunk of the cell for the background reader, when it is neither resident nor queued
+    void prefetch(int x, int y);
+
+private:
+    struct ChunkSlot {
+        uint32_t chunkId;
+        uint64_t lastUse;
+        std::vector<uint64_t> words;
+    };
+
+    static constexpr uint32_t NO_CHUNK = ~0u;
+    static constexpr uint32_t FILE_MAGIC = 0x31474D54; // "TMG1"
+
+    std::string path;
+    std::ifstream file;
+
+    int width = 0;
+    int height = 0;
+    int chunkSide = 0;
+    uint32_t numChunksX = 0;
+    uint32_t numChunksY = 0;
+    unsigned int wordsPerChunk = 0;
+    unsigned int maxResidentChunks = 0;
+    // Shares of maxResidentChunks, prefetching is off when the budget is too small for it
+    unsigned int maxReadyChunks = 0;
+    unsigned int maxSlots = 0;
+
+    // Owned by the planning thread
+    std::vector<ChunkSlot> slots;
+    // Chunk to its slot, NO_CHUNK once evicted
+    FlatMap<uint32_t> chunkSlots;
+    // Chunks handed to the reader and not consumed yet
+    FlatMap<uint8_t> pendingChunks;
+    uint32_t lastChunkId = NO_CHUNK;
+    uint32_t lastSlot = 0;
+    uint64_t useCounter = 0;
+    TiledGridStats stats;
+
+    // Shared with the reader under readerMutex
+    std::thread reader;
+    std::mutex readerMutex;
+    std::condition_variable readerWakeup;
+    std::condition_variable readerIdle;
+    std::deque<uint32_t> requestedChunks;
+    std::vector<std::pair<uint32_t, std::vector<uint64_t>>> readyChunks;
+    // Chunks the reader dropped or failed to read, their pending marks are cleared by the planning thread
+    std::vector<uint32_t> droppedChunks;
+    bool isReading = false;
+    bool isStopping = false;
+
+    bool isResident(uint32_t chunkId) const;
+    void useChunk(uint32_t chunkId);
+    void loadChunk(uint32_t chunkId);
+    // Call with readerMutex held
+    void clearDroppedChunks();
+
+    bool readChunk(std::ifstream& chunkFile, uint32_t chunkId, std::vector<uint64_t>& words) const;
+
+    void runReader();
+    void stopReader();
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef TILED_GRID_STATE_H
+#define TILED_GRID_STATE_H
+
+#include <cstdint>
+#include <vector>
+#include "tiled_grid_map.hpp"
+
+/***
+    Tiled Grid State
+    4 connected cell of a TiledGridMap, with the moves and costs of GridState. Expanding a cell
+    within PREFETCH_MARGIN cells of its chunk border prefetches the chunk across that border,
+    so the chunks ahead of the frontier are usually resident before the search enters them.
+    Unique ids are row major, the grid must have at most 2^32 cells. The map must outlive its states.
+*/
+class TiledGridState {
+public:
+    int x;
+    int y;
+
+    static constexpr unsigned int MAX_NEXT_STATES = 4;
+    static constexpr int PREFETCH_MARGIN = 8;
+
+    TiledGridState();
+    TiledGridState(TiledGridMap& map, int x, int y);
+    uint32_t getUniqueId();
+    std::vector<TiledGridState> getNextStates();
+    unsigned int getNextStates(TiledGridState* nextStates);
+
+    int numberOfNearbyObstacles();
+
+private:
+    TiledGridMap* map;
+
+    void prefetchAhead();
+};
+
+
+#endif
\ No newline at end of file
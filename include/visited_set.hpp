@@ -0,0 +1,57 @@
+#ifndef VISITED_SET_H
+#define VISITED_SET_H
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+
+/***
+    Visited Set
+    Dense set of node ids backed by an epoch array.
+    clear() only bumps the epoch, so the set can be reused between searches
+    without touching the array. Grows on demand to the largest id inserted,
+    which assumes the node ids are dense (such as GridState ids).
+*/
+class VisitedSet {
+public:
+    VisitedSet() : epoch(1) {};
+
+    bool contains(uint32_t id) const {
+        return id < marks.size() && marks[id] == epoch;
+    };
+
+    void insert(uint32_t id) {
+        if (id >= marks.size()) grow(id);
+        marks[id] = epoch;
+    };
+
+    void erase(uint32_t id) {
+        if (id < marks.size()) marks[id] = 0;
+    };
+
+    // O(1) except once every 2^32 clears when the epoch wraps around
+    void clear() {
+        epoch += 1;
+        if (epoch == 0) {
+            std::fill(marks.begin(), marks.end(), 0);
+            epoch = 1;
+        }
+    };
+
+    void reserve(uint32_t numNodes) {
+        if (numNodes > marks.size()) marks.resize(numNodes, 0);
+    };
+
+private:
+    std::vector<uint32_t> marks;
+    uint32_t epoch;
+
+    void grow(uint32_t id) {
+        size_t newSize = marks.size() * 2;
+        if (newSize <= id) newSize = static_cast<size_t>(id) + 1;
+        marks.resize(newSize, 0);
+    };
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef VOXEL_MAP_H
+#define VOXEL_MAP_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "flat_map.hpp"
+
+
+/***
+    Voxel Map
+    Sparse occupancy of a 3D grid in bricks of BRICK_SIDE^3 voxels. A brick is only stored
+    once an obstacle lies in it or next to it, every other voxel is free with no nearby
+    obstacles. A brick holds one bit per voxel and the number of obstacles among the six
+    neighbors of each voxel, patched by setObstacle, so proximity costs are a single lookup.
+    Planning only reads the map, planners on different threads can share it while nobody edits it.
+*/
+class VoxelMap {
+public:
+    static constexpr int BRICK_SIDE = 8;
+
+    VoxelMap(int width, int height, int depth);
+
+    int getWidth() const {
+        return width;
+    };
+
+    int getHeight() const {
+        return height;
+    };
+
+    int getDepth() const {
+        return depth;
+    };
+
+    bool isInside(int x, int y, int z) const {
+        return x >= 0 && y >= 0 && z >= 0 && x < width && y < height && z < depth;
+    };
+
+    bool isObstacle(int x, int y, int z) const;
+
+    // Obstacles among the six neighbors inside the grid
+    int getObstacleCount(int x, int y, int z) const;
+
+    void setObstacle(int x, int y, int z, bool isObstacle);
+
+    // Row major id of the voxel, the grid must have at most 2^32 voxels
+    uint32_t voxelIndex(int x, int y, int z) const {
+        return (static_cast<uint32_t>(z) * height + y) * width + x;
+    };
+
+    unsigned int getNumBricks() const {
+        return bricks.size();
+    };
+
+private:
+    static constexpr int BRICK_VOXELS = BRICK_SIDE * BRICK_SIDE * BRICK_SIDE;
+
+    struct Brick {
+        std::array<uint64_t, BRICK_VOXELS / 64> occupancy;
+        std::array<uint8_t, BRICK_VOXELS> obstacleCounts;
+    };
+
+    int width;
+    int height;
+    int depth;
+    uint32_t numBricksX;
+    uint32_t numBricksY;
+
+    // Brick id to its index in bricks
+    FlatMap<uint32_t> brickIndices;
+    std::vector<Brick> bricks;
+
+    uint32_t brickId(int x, int y, int z) const;
+    const Brick* findBrick(int x, int y, int z) const;
+    Brick& getBrick(int x, int y, int z);
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef VOXEL_STATE_H
+#define VOXEL_STATE_H
+
+#include <cstdint>
+#include <vector>
+#include "voxel_map.hpp"
+
+// Moves of a VoxelState, faces only or faces, edges and corners
+enum class VoxelConnectivity {
+    SIX = 6,
+    TWENTY_SIX = 26
+};
+
+
+/***
+    Voxel State
+    Voxel of a VoxelMap. A move may not cut corners or edges: every voxel of the box spanned by
+    the move must be free. A move costs its euclidean length in fixed point units of
+    1 / COST_SCALE, so path costs add up exactly in IDP. The map must outlive its states.
+*/
+class VoxelState {
+public:
+    int x;
+    int y;
+    int z;
+
+    static constexpr unsigned int MAX_NEXT_STATES = 26;
+    static constexpr int COST_SCALE = 1000;
+
+    VoxelState();
+    VoxelState(const VoxelMap& map, int x, int y, int z, VoxelConnectivity connectivity = VoxelConnectivity::TWENTY_SIX);
+    uint32_t getUniqueId();
+    std::vector<VoxelState> getNextStates();
+    unsigned int getNextStates(VoxelState* nextStates);
+
+    int numberOfNearbyObstacles();
+
+    // Cost of the move to a next state
+    int getMoveCost(const VoxelState& toState) const;
+
+    const VoxelMap* getMap() const;
+
+private:
+    const VoxelMap* map;
+    VoxelConnectivity connectivity;
+
+    bool isFree(int voxelX, int voxelY, int voxelZ) const;
+};
+
+
+#endif
\ No newline at end of file
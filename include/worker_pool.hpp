@@ -0,0 +1,56 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/***
+    Worker Pool
+    Threads started once and reused by every parallel phase of a search, instead of
+    spawning threads per phase. run(numTasks, task) calls task(i) for every i in
+    [0, numTasks) on the workers and on the calling thread, and returns once all calls
+    are done. Phases of concurrent callers run one after the other.
+*/
+class WorkerPool {
+public:
+    // numThreads counts the calling thread, so numThreads - 1 workers are started
+    WorkerPool(unsigned int numThreads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned int getNumThreads() const {
+        return workers.size() + 1;
+    };
+
+    void run(unsigned int numTasks, const std::function<void(unsigned int)>& task);
+
+private:
+    std::vector<std::thread> workers;
+
+    // Held for a whole phase, the members below are guarded by mutex
+    std::mutex phaseMutex;
+    std::mutex mutex;
+    std::condition_variable workerWakeup;
+    std::condition_variable phaseDone;
+
+    const std::function<void(unsigned int)>* task = nullptr;
+    unsigned int numTasks = 0;
+    unsigned int nextTask = 0;
+    unsigned int numTasksDone = 0;
+    uint64_t phase = 0;
+    bool isStopping = false;
+
+    void runWorker();
+
+    // Takes tasks of the current phase until none is left
+    void runTasks();
+};
+
+#endif
\ No newline at end of file
@@ -1,12 +1,91 @@
 #include "../../include/example_setup.hpp"
+#include "../../include/idp_engine.hpp"
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <utility>
 #include <vector>
 
-ExampleSetup::ExampleSetup(int gridWidth, int gridHeight)  {
-
-    GridState::GRID_HEIGHT = gridHeight;
-    GridState::GRID_WIDTH = gridWidth;
-
-    GridState::CELL_STATES = std::vector<bool>(gridWidth * gridHeight, false);
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+enum class HardwareEvent {
+    CACHE_MISSES,
+    DTLB_MISSES
+};
+
+// Counts a hardware event of the calling thread in user space
+// Unavailable outside Linux, or when perf events are not permitted, the benchmark then only reports time
+class HardwareCounter {
+public:
+    HardwareCounter(HardwareEvent event) {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        if (event == HardwareEvent::CACHE_MISSES) {
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        } else {
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+
+        this->fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~HardwareCounter() {
+#if defined(__linux__)
+        if (this->fd >= 0) close(this->fd);
+#endif
+    }
+
+    HardwareCounter(const HardwareCounter&) = delete;
+    HardwareCounter& operator=(const HardwareCounter&) = delete;
+
+    bool isAvailable() const {
+        return this->fd >= 0;
+    }
+
+    void start() {
+#if defined(__linux__)
+        if (this->fd < 0) return;
+        ioctl(this->fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(this->fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    // Events since start
+    uint64_t stop() {
+        uint64_t count = 0;
+#if defined(__linux__)
+        if (this->fd < 0) return 0;
+        ioctl(this->fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(this->fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd = -1;
+};
+
+
+ExampleSetup::ExampleSetup(int gridWidth, int gridHeight, GridLayout layout) :
+    ExampleSetup(std::make_shared<GridMap>(gridWidth, gridHeight, layout)) {}
+
+
+ExampleSetup::ExampleSetup(std::shared_ptr<GridMap> gridMap) : gridMap(gridMap) {
 
     constexpr unsigned int numMonoids = 2;
 
@@ -33,7 +112,10 @@ ExampleSetup::ExampleSetup(int gridWidth, int gridHeight)  {
     };    
 
 
-    singleOptimalPathFinder = SingleOptimalPathFinder<GridState>(identity, compares, binaryOperators, computes);
+    // Both monoids are non-negative integer additions, so a single lexicographic Dijkstra is enough
+    constexpr bool isLexicographic = true;
+
+    singleOptimalPathFinder = SingleOptimalPathFinder<GridState>(identity, compares, binaryOperators, computes, isLexicographic);
     idpAlgorithm = IteratedDijkstraPropagation();
 }
 
@@ -50,15 +132,25 @@ std::vector<GridState> ExampleSetup::getOptimalEdges(GridState start, GridState
 
 // Setup functions
 
+std::shared_ptr<GridMap> ExampleSetup::getMap() {
+    return gridMap;
+}
+
+
+GridState ExampleSetup::getCell(int x, int y) {
+    return GridState(*gridMap, x, y);
+}
+
+
 // there is obstacle at x, y
 void ExampleSetup::setObstacle(int x, int y) {
-    GridState::CELL_STATES[y * GridState::GRID_WIDTH + x] = true;
+    gridMap->setObstacle(x, y, true);
 }
 
 
 // there is no obstacle at x, y
 void ExampleSetup::noObstacle(int x, int y) {
-    GridState::CELL_STATES[y * GridState::GRID_WIDTH + x] = false;
+    gridMap->setObstacle(x, y, false);
 }
 
 
@@ -68,6 +160,81 @@ void ExampleSetup::resetGraph() {
 
 
 
+EngineBenchmark ExampleSetup::benchmarkEngine(unsigned int numQueries, unsigned int seed) {
+    constexpr unsigned int numMonoids = 2;
+
+    MonoMulticostProps<int, numMonoids> props({0, 0}, {compareDistanceCost, compareObstacleCost}, {addDistanceCost, addObstacleCost});
+    std::shared_ptr<MonoMulticostArray<int, numMonoids>> multicostArray = std::make_shared<MonoMulticostArray<int, numMonoids>>(props);
+    std::shared_ptr<IMulticostCompute<GridState>> compute = std::make_shared<MonoMulticostCompute<GridState, int, numMonoids>>(
+        multicostArray, std::array<std::function<int(GridState& a, GridState& b)>, numMonoids>{computeDistanceCost, computeObstacleCost});
+
+    LazyMulticostGraph<GridState> graph(multicostArray, compute);
+
+    // Node ids follow the layout of the cells
+    std::vector<uint32_t> freeCells;
+    for (uint32_t index = 0; index < gridMap->numCells(); ++index) {
+        if (gridMap->isObstacleAt(index)) continue;
+        freeCells.push_back(graph.addNode(GridState::cellAt(*gridMap, index)));
+    }
+
+    EngineBenchmark benchmark;
+    if (freeCells.size() == 0) return benchmark;
+
+    // Explores every cell, so neither side pays for lazy edge computations
+    std::vector<uint32_t> nodeIds;
+    CompactGraph<AdditiveCosts<int, numMonoids>> compactGraph = buildCompactGraph<AdditiveCosts<int, numMonoids>>(graph, *multicostArray, freeCells, nodeIds);
+    IdpEngine<CompactGraph<AdditiveCosts<int, numMonoids>>, AdditiveCosts<int, numMonoids>> engine(compactGraph);
+
+    std::vector<uint32_t> nodeToIndex(graph.getNumNodes(), 0);
+    for (uint32_t i = 0; i < nodeIds.size(); ++i) nodeToIndex[nodeIds[i]] = i;
+
+    IteratedDijkstraPropagation idp;
+    QueryWorkspace workspace;
+    std::vector<uint32_t> idpPath;
+    std::vector<uint32_t> enginePath;
+
+    auto pathCost = [&graph](const std::vector<uint32_t>& path, const std::vector<uint32_t>& ids) {
+        std::array<int, numMonoids> cost = {0, 0};
+        for (unsigned int i = 0; i + 1 < path.size(); ++i) {
+            GridState fromCell = graph.getNode(ids[path[i]]);
+            GridState toCell = graph.getNode(ids[path[i + 1]]);
+            cost[0] += computeDistanceCost(fromCell, toCell);
+            cost[1] += computeObstacleCost(fromCell, toCell);
+        }
+        return cost;
+    };
+
+    std::vector<uint32_t> identityIds(graph.getNumNodes());
+    for (uint32_t i = 0; i < identityIds.size(); ++i) identityIds[i] = i;
+
+    std::mt19937 random(seed);
+
+    for (unsigned int q = 0; q < numQueries; ++q) {
+        uint32_t start = freeCells[random() % freeCells.size()];
+        uint32_t end = freeCells[random() % freeCells.size()];
+
+        QueryCancellation cancellation;
+        QueryProgress progress;
+
+        auto idpBegin = std::chrono::steady_clock::now();
+        idp.getOptimalPath(graph, multicostArray, start, end, idpPath, workspace, cancellation, progress);
+        auto engineBegin = std::chrono::steady_clock::now();
+        engine.getOptimalPath(nodeToIndex[start], nodeToIndex[end], enginePath);
+        auto engineEnd = std::chrono::steady_clock::now();
+
+        benchmark.numQueries++;
+        benchmark.idpMilliseconds += std::chrono::duration<double, std::milli>(engineBegin - idpBegin).count();
+        benchmark.engineMilliseconds += std::chrono::duration<double, std::milli>(engineEnd - engineBegin).count();
+
+        // Ties can give paths of other lengths, only their multicosts have to match
+        if (idpPath.empty() != enginePath.empty() || pathCost(idpPath, identityIds) != pathCost(enginePath, nodeIds)) benchmark.numMismatches++;
+    }
+
+    return benchmark;
+}
+
+
+
 // Multicost functions
 
 // positive is larger, negative is smaller, 0 is equal.
@@ -100,3 +267,72 @@ int ExampleSetup::computeDistanceCost(GridState& fromCell, GridState& toCell) {
 int ExampleSetup::computeObstacleCost(GridState& fromState, GridState& toState) {
     return fromState.numberOfNearbyObstacles() + toState.numberOfNearbyObstacles();
 }
+
+
+
+std::vector<LayoutBenchmark> ExampleSetup::benchmarkLayouts(unsigned int numQueries, unsigned int seed) {
+    constexpr unsigned int numMonoids = 2;
+
+    MonoMulticostProps<int, numMonoids> props({0, 0}, {compareDistanceCost, compareObstacleCost}, {addDistanceCost, addObstacleCost});
+    std::shared_ptr<MonoMulticostArray<int, numMonoids>> multicostArray = std::make_shared<MonoMulticostArray<int, numMonoids>>(props);
+    std::shared_ptr<IMulticostCompute<GridState>> compute = std::make_shared<MonoMulticostCompute<GridState, int, numMonoids>>(
+        multicostArray, std::array<std::function<int(GridState& a, GridState& b)>, numMonoids>{computeDistanceCost, computeObstacleCost});
+
+    std::vector<LayoutBenchmark> benchmarks;
+
+    std::vector<std::pair<int, int>> freeCells;
+    for (int y = 0; y < gridMap->getHeight(); ++y) {
+        for (int x = 0; x < gridMap->getWidth(); ++x) {
+            if (!gridMap->isObstacle(x, y)) freeCells.push_back({x, y});
+        }
+    }
+    if (freeCells.size() == 0) return benchmarks;
+
+    std::mt19937 random(seed);
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> queries(numQueries);
+    for (auto& query : queries) query = {freeCells[random() % freeCells.size()], freeCells[random() % freeCells.size()]};
+
+    for (GridLayout benchmarkLayout : {GridLayout::ROW_MAJOR, GridLayout::Z_ORDER, GridLayout::HILBERT}) {
+        GridMap map = *gridMap;
+        map.setLayout(benchmarkLayout);
+
+        LazyMulticostGraph<GridState> graph(multicostArray, compute);
+        for (uint32_t index = 0; index < map.numCells(); ++index) {
+            if (!map.isObstacleAt(index)) graph.addNode(GridState::cellAt(map, index));
+        }
+
+        LayoutBenchmark benchmark;
+        benchmark.layout = benchmarkLayout;
+
+        auto exploreBegin = std::chrono::steady_clock::now();
+        for (uint32_t id = 0; id < graph.getNumNodes(); ++id) graph.getNextEdges(id, IMulticostGraph::ALL_MONOIDS);
+        benchmark.exploreMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - exploreBegin).count();
+
+        IteratedDijkstraPropagation idp;
+        QueryWorkspace workspace;
+        std::vector<uint32_t> path;
+
+        HardwareCounter cacheMisses(HardwareEvent::CACHE_MISSES);
+        HardwareCounter dtlbMisses(HardwareEvent::DTLB_MISSES);
+        benchmark.hasCounters = cacheMisses.isAvailable() && dtlbMisses.isAvailable();
+
+        cacheMisses.start();
+        dtlbMisses.start();
+        auto queryBegin = std::chrono::steady_clock::now();
+        for (const auto& [start, end] : queries) {
+            QueryCancellation cancellation;
+            QueryProgress progress;
+
+            uint32_t startId = graph.getNodeIndex(map.cellIndex(start.first, start.second));
+            uint32_t endId = graph.getNodeIndex(map.cellIndex(end.first, end.second));
+            idp.getOptimalPath(graph, multicostArray, startId, endId, path, workspace, cancellation, progress);
+        }
+        benchmark.queryMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queryBegin).count();
+        benchmark.cacheMisses = cacheMisses.stop();
+        benchmark.dtlbMisses = dtlbMisses.stop();
+
+        benchmarks.push_back(benchmark);
+    }
+
+    return benchmarks;
+}
@@ -0,0 +1,252 @@
+#include "../../include/moving_ai_benchmark.hpp"
+#include "../../include/grid_map.hpp"
+#include "../../include/iterated_dijkstra_propagation.hpp"
+#include "../../include/single_optimal_path_finder.hpp"
+#include "../../include/terrain_grid_state.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+static bool readFile(const std::string& path, std::string& contents) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    contents.resize(size);
+    return static_cast<bool>(file.read(&contents[0], size));
+}
+
+
+// Next line of text starting at pos without its line break, false at the end of text
+static bool nextLine(const std::string& text, size_t& pos, const char*& line, size_t& length) {
+    if (pos >= text.size()) return false;
+
+    size_t end = text.find('\n', pos);
+    if (end == std::string::npos) end = text.size();
+
+    line = text.data() + pos;
+    length = end - pos;
+    if (length > 0 && line[length - 1] == '\r') --length;
+
+    pos = end + 1;
+    return true;
+}
+
+
+
+bool loadMovingAiMap(const std::string& path, std::shared_ptr<GridMap>& map, GridLayout layout) {
+    std::string text;
+    if (!readFile(path, text)) return false;
+
+    size_t pos = 0;
+    const char* line;
+    size_t length;
+
+    int width = 0;
+    int height = 0;
+
+    // Header lines up to "map": type octile, height H, width W
+    while (true) {
+        if (!nextLine(text, pos, line, length)) return false;
+
+        std::string header(line, length);
+        if (header == "map") break;
+
+        std::istringstream fields(header);
+        std::string key;
+        fields >> key;
+        if (key == "height") fields >> height;
+        if (key == "width") fields >> width;
+    }
+
+    if (width <= 0 || height <= 0) return false;
+
+    std::vector<bool> obstacles(width * height);
+
+    for (int y = 0; y < height; ++y) {
+        if (!nextLine(text, pos, line, length) || length < static_cast<size_t>(width)) return false;
+
+        for (int x = 0; x < width; ++x) {
+            char terrain = line[x];
+            obstacles[y * width + x] = terrain != '.' && terrain != 'G' && terrain != 'S';
+        }
+    }
+
+    map = std::make_shared<GridMap>(width, height, layout);
+    map->setObstacles(obstacles);
+
+    return true;
+}
+
+
+
+// Malformed scenario rows are reported with their line number, counted from 1
+static bool badScenario(const std::string& path, unsigned int lineNumber, const char* reason) {
+    std::cerr << "ERROR: [loadMovingAiScenarios] " << path << " line " << lineNumber << ": " << reason << std::endl;
+    return false;
+}
+
+
+static bool loadScenarios(const std::string& path, const GridMap* map, std::vector<MovingAiScenario>& scenarios) {
+    std::string text;
+    if (!readFile(path, text)) return false;
+
+    size_t pos = 0;
+    const char* line;
+    size_t length;
+
+    scenarios.clear();
+
+    // The first line is the version
+    if (!nextLine(text, pos, line, length)) return false;
+    unsigned int lineNumber = 1;
+
+    while (nextLine(text, pos, line, length)) {
+        lineNumber++;
+        if (length == 0) continue;
+
+        // bucket, map, map width, map height, start x, start y, goal x, goal y, optimal length
+        std::istringstream fields(std::string(line, length));
+        MovingAiScenario scenario;
+        std::string mapName;
+
+        fields >> scenario.bucket >> mapName >> scenario.mapWidth >> scenario.mapHeight
+            >> scenario.startX >> scenario.startY >> scenario.goalX >> scenario.goalY >> scenario.optimalLength;
+        if (!fields) return badScenario(path, lineNumber, "expected bucket, map, width, height, start x, start y, goal x, goal y and length");
+
+        if (scenario.mapWidth <= 0 || scenario.mapHeight <= 0) return badScenario(path, lineNumber, "map size is not positive");
+
+        if (map != nullptr && (scenario.mapWidth != map->getWidth() || scenario.mapHeight != map->getHeight())) {
+            return badScenario(path, lineNumber, "map size differs from the loaded map");
+        }
+
+        bool isStartInside = scenario.startX >= 0 && scenario.startX < scenario.mapWidth && scenario.startY >= 0 && scenario.startY < scenario.mapHeight;
+        bool isGoalInside = scenario.goalX >= 0 && scenario.goalX < scenario.mapWidth && scenario.goalY >= 0 && scenario.goalY < scenario.mapHeight;
+        if (!isStartInside || !isGoalInside) return badScenario(path, lineNumber, "start or goal is outside the map");
+
+        scenarios.push_back(scenario);
+    }
+
+    return true;
+}
+
+
+bool loadMovingAiScenarios(const std::string& path, std::vector<MovingAiScenario>& scenarios) {
+    return loadScenarios(path, nullptr, scenarios);
+}
+
+
+bool loadMovingAiScenarios(const std::string& path, const GridMap& map, std::vector<MovingAiScenario>& scenarios) {
+    return loadScenarios(path, &map, scenarios);
+}
+
+
+
+std::vector<MovingAiBucketResult> runMovingAiScenarios(std::shared_ptr<const GridMap> map, const std::vector<MovingAiScenario>& scenarios) {
+    std::vector<MovingAiQueryResult> queries;
+    return runMovingAiScenarios(map, scenarios, queries);
+}
+
+
+std::vector<MovingAiBucketResult> runMovingAiScenarios(std::shared_ptr<const GridMap> map, const std::vector<MovingAiScenario>& scenarios, std::vector<MovingAiQueryResult>& queries, IHeapMeter* heapMeter) {
+    constexpr unsigned int numMonoids = 2;
+
+    std::array<std::function<int(int a, int b)>, numMonoids> compares = {
+        [](int a, int b) { return a - b; },
+        [](int a, int b) { return a - b; }
+    };
+
+    std::array<std::function<int(int a, int b)>, numMonoids> ops = {
+        [](int a, int b) { return a + b; },
+        [](int a, int b) { return a + b; }
+    };
+
+    // Costs of all the moves of a cell at once
+    std::array<std::function<void(TerrainGridState& a, TerrainGridState* bs, unsigned int numStates, int* costs)>, numMonoids> batchComputes = {
+        [](TerrainGridState& a, TerrainGridState* bs, unsigned int numStates, int* costs) {
+            a.getMoveCosts(bs, numStates, costs);
+        },
+        [](TerrainGridState& a, TerrainGridState* bs, unsigned int numStates, int* costs) {
+            int fromObstacles = a.numberOfNearbyObstacles();
+            for (unsigned int i = 0; i < numStates; ++i) costs[i] = fromObstacles + bs[i].numberOfNearbyObstacles();
+        }
+    };
+
+    std::vector<MovingAiBucketResult> results;
+    queries.clear();
+    queries.reserve(scenarios.size());
+
+    for (const MovingAiScenario& scenario : scenarios) {
+        while (results.size() <= scenario.bucket) {
+            results.emplace_back();
+            results.back().bucket = results.size() - 1;
+        }
+
+        TerrainGridState start(*map, scenario.startX, scenario.startY);
+        TerrainGridState goal(*map, scenario.goalX, scenario.goalY);
+
+        MovingAiQueryResult query;
+        query.bucket = scenario.bucket;
+        query.optimalLength = scenario.optimalLength;
+
+        int64_t heapBytes = 0;
+        uint64_t numAllocations = 0;
+        if (heapMeter != nullptr) {
+            heapMeter->resetPeak();
+            heapBytes = heapMeter->getBytesInUse();
+            numAllocations = heapMeter->getNumAllocations();
+        }
+
+        std::vector<TerrainGridState> path;
+        {
+            // The planner, its graph and its workspace belong to this query alone
+            SingleOptimalPathFinder<TerrainGridState> pathFinder(std::array<int, numMonoids>{0, 0}, compares, ops, batchComputes, true);
+            IteratedDijkstraPropagation idpAlgorithm;
+
+            auto queryBegin = std::chrono::steady_clock::now();
+            path = pathFinder.getOptimalPath(idpAlgorithm, start, goal);
+            query.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - queryBegin).count();
+
+            query.numExpansions = pathFinder.getNumExpandedNodes();
+            query.numNodes = pathFinder.getNumNodes();
+        }
+
+        if (heapMeter != nullptr) {
+            query.peakHeapBytes = heapMeter->getPeakBytes() - heapBytes;
+            query.numAllocations = heapMeter->getNumAllocations() - numAllocations;
+        }
+
+        MovingAiBucketResult& result = results[scenario.bucket];
+        result.numQueries++;
+        result.numExpansions += query.numExpansions;
+        result.totalMilliseconds += query.milliseconds;
+        result.maxMilliseconds = std::max(result.maxMilliseconds, query.milliseconds);
+        result.maxPeakHeapBytes = std::max(result.maxPeakHeapBytes, query.peakHeapBytes);
+
+        // A path needs at least one edge, start == goal has none
+        bool isTrivial = start.getUniqueId() == goal.getUniqueId();
+        query.isSolved = path.size() > 0 || isTrivial;
+        if (!query.isSolved) result.numUnsolved++;
+
+        if (path.size() > 0) {
+            int cost = 0;
+            for (unsigned int i = 0; i + 1 < path.size(); ++i) cost += path[i].getMoveCost(path[i + 1]);
+
+            // Every move is rounded to the fixed point units by at most half a unit
+            query.length = static_cast<double>(cost) / TerrainGridState::COST_SCALE;
+            double tolerance = 0.5 * path.size() / TerrainGridState::COST_SCALE + 1e-6;
+            if (query.length > scenario.optimalLength + tolerance) result.numSuboptimal++;
+        }
+
+        queries.push_back(query);
+    }
+
+    return results;
+}
\ No newline at end of file
@@ -0,0 +1,496 @@
+#include "../../include/contraction_hierarchy_propagation.hpp"
+#include "../../include/heap.hpp"
+#include "../../include/query_workspace.hpp"
+#include "../../include/visited_set.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+
+void ContractionHierarchyPropagation::preprocess(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, const std::vector<uint32_t>& seeds) {
+    hierarchyGraph = &graph;
+    hierarchyArray = multicostArray;
+
+    nodeToIndex.clear();
+    indexToNode.clear();
+    ranks.clear();
+    arcs.clear();
+    outArcs.clear();
+    inArcs.clear();
+    contracted.clear();
+    stats = ContractionHierarchyStats();
+
+    auto exploreBegin = std::chrono::steady_clock::now();
+    explore(graph, seeds);
+    auto contractBegin = std::chrono::steady_clock::now();
+    contract();
+    auto contractEnd = std::chrono::steady_clock::now();
+
+    stats.numNodes = indexToNode.size();
+    stats.exploreMilliseconds = std::chrono::duration<double, std::milli>(contractBegin - exploreBegin).count();
+    stats.contractMilliseconds = std::chrono::duration<double, std::milli>(contractEnd - contractBegin).count();
+}
+
+
+
+void ContractionHierarchyPropagation::getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, std::vector<uint32_t>& path, QueryWorkspace& workspace, QueryCancellation& cancellation, QueryProgress& progress) {
+    path.clear();
+
+    OptimalSubgraph& optimalSubgraph = this->optimalSubgraph(graph, multicostArray, start, end, workspace, cancellation, progress);
+
+    if (!optimalSubgraph.isGraphExists()) return;
+
+    extractPath(start, end, workspace, path);
+}
+
+
+
+OptimalSubgraph&
+ContractionHierarchyPropagation::optimalSubgraph(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryWorkspace& workspace, QueryCancellation& cancellation, QueryProgress& progress) {
+    const uint32_t* startIndex = nodeToIndex.find(start);
+    const uint32_t* endIndex = nodeToIndex.find(end);
+
+    if (&graph != hierarchyGraph || multicostArray != hierarchyArray || startIndex == nullptr || endIndex == nullptr) {
+        return IteratedDijkstraPropagation::optimalSubgraph(graph, multicostArray, start, end, workspace, cancellation, progress);
+    }
+
+    OptimalSubgraph& optimalSubgraph = workspace.getOptimalSubgraph(graph);
+
+    progress.numMonoidsOptimal = 0;
+    progress.numMonoidsSkipped = 0;
+    progress.isComplete = false;
+
+    HierarchySearch& search = threadSearch();
+    HierarchyWeights& forwardWeights = search.forwardWeights;
+    HierarchyWeights& backwardWeights = search.backwardWeights;
+
+    if (!upwardSearch(*startIndex, true, search, forwardWeights, cancellation)) return optimalSubgraph;
+    if (!upwardSearch(*endIndex, false, search, backwardWeights, cancellation)) return optimalSubgraph;
+
+    // Every node where the two searches meet at the optimal cost lies on an optimal up-down path
+    std::unique_ptr<MulticostID> optimalCost;
+    std::unique_ptr<MulticostID> totalCost = multicostArray->identity();
+    std::vector<uint32_t>& meetingNodes = search.meetingNodes;
+    meetingNodes.clear();
+
+    for (uint32_t node : forwardWeights.settledNodes) {
+        if (!backwardWeights.contains(node)) continue;
+
+        multicostArray->op(forwardWeights.get(node), backwardWeights.get(node), totalCost, 0);
+
+        int comp = optimalCost ? multicostArray->compare(totalCost, optimalCost, 0) : -1;
+        if (comp < 0) {
+            optimalCost = multicostArray->copy(totalCost);
+            meetingNodes.clear();
+        }
+        if (comp <= 0) meetingNodes.push_back(node);
+    }
+
+    if (!optimalCost) {
+        progress.isComplete = true;
+        return optimalSubgraph;
+    }
+
+    search.unpackedArcs.clear();
+    search.addedEdges.clear();
+
+    // Walk the upward arcs that are tight in the forward search down to start
+    std::vector<uint32_t>& stack = search.stack;
+    stack = meetingNodes;
+
+    search.marked.clear();
+    for (uint32_t node : meetingNodes) search.marked.insert(node);
+
+    while (stack.size() > 0) {
+        uint32_t node = stack.back();
+        stack.pop_back();
+
+        const std::unique_ptr<MulticostID>& nodeWeight = forwardWeights.get(node);
+
+        for (uint32_t arcId : inArcs[node]) {
+            uint32_t frNode = arcs[arcId].frNode;
+            if (ranks[frNode] > ranks[node] || !forwardWeights.contains(frNode)) continue;
+
+            multicostArray->op(forwardWeights.get(frNode), arcs[arcId].cost, totalCost, 0);
+            if (multicostArray->compare(totalCost, nodeWeight, 0) != 0) continue;
+
+            addUnpackedEdges(arcId, search, optimalSubgraph);
+            if (!search.marked.contains(frNode)) {
+                search.marked.insert(frNode);
+                stack.push_back(frNode);
+            }
+        }
+    }
+
+    // And the arcs that are tight in the backward search down to end
+    stack = meetingNodes;
+
+    search.marked.clear();
+    for (uint32_t node : meetingNodes) search.marked.insert(node);
+
+    while (stack.size() > 0) {
+        uint32_t node = stack.back();
+        stack.pop_back();
+
+        const std::unique_ptr<MulticostID>& nodeWeight = backwardWeights.get(node);
+
+        for (uint32_t arcId : outArcs[node]) {
+            uint32_t toNode = arcs[arcId].toNode;
+            if (ranks[toNode] > ranks[node] || !backwardWeights.contains(toNode)) continue;
+
+            multicostArray->op(backwardWeights.get(toNode), arcs[arcId].cost, totalCost, 0);
+            if (multicostArray->compare(totalCost, nodeWeight, 0) != 0) continue;
+
+            addUnpackedEdges(arcId, search, optimalSubgraph);
+            if (!search.marked.contains(toNode)) {
+                search.marked.insert(toNode);
+                stack.push_back(toNode);
+            }
+        }
+    }
+
+    if (!optimalSubgraph.isGraphExists()) {
+        progress.isComplete = true;
+        return optimalSubgraph;
+    }
+
+    optimalSubgraph.notInitial();
+    recordPredecessors(optimalSubgraph, start, workspace);
+    progress.numMonoidsOptimal = 1;
+
+    unsigned int numMonoids = multicostArray->num_monoids();
+
+    for (unsigned int i = 1; i < numMonoids && !optimalSubgraph.isSinglePath(); ++i) {
+        if (!iterate(optimalSubgraph, multicostArray, start, end, i, workspace, cancellation)) return optimalSubgraph;
+        if (!optimalSubgraph.isGraphExists()) break;
+        progress.numMonoidsOptimal = i + 1;
+    }
+
+    if (optimalSubgraph.isSinglePath()) {
+        progress.numMonoidsSkipped = numMonoids - progress.numMonoidsOptimal;
+        progress.numMonoidsOptimal = numMonoids;
+    }
+
+    progress.isComplete = true;
+
+    return optimalSubgraph;
+}
+
+
+
+void ContractionHierarchyPropagation::explore(IMulticostGraph& graph, const std::vector<uint32_t>& seeds) {
+    std::queue<uint32_t> queueNodes;
+
+    for (uint32_t seed : seeds) {
+        if (nodeToIndex.contains(seed)) continue;
+        addNode(seed);
+        queueNodes.push(seed);
+    }
+
+    while (queueNodes.size() > 0) {
+        uint32_t nodeId = queueNodes.front();
+        queueNodes.pop();
+
+        uint32_t frNode = nodeToIndex.at(nodeId);
+
+        for (const MulticostEdge& edge : graph.getNextEdges(nodeId, 0)) {
+            const uint32_t* toIndex = nodeToIndex.find(edge.nodeId);
+            uint32_t toNode;
+
+            if (toIndex == nullptr) {
+                toNode = addNode(edge.nodeId);
+                queueNodes.push(edge.nodeId);
+            } else {
+                toNode = *toIndex;
+            }
+
+            if (frNode == toNode) continue;
+
+            addArc(frNode, toNode, hierarchyArray->copy(graph.getEdgeCost(edge.edgeCostId)), &edge, nullptr);
+            stats.numEdges += 1;
+        }
+    }
+}
+
+
+
+void ContractionHierarchyPropagation::contract() {
+    unsigned int numNodes = indexToNode.size();
+
+    contracted = std::vector<bool>(numNodes, false);
+    ranks = std::vector<unsigned int>(numNodes, 0);
+    std::vector<int> numContractedNeighbors(numNodes, 0);
+
+    // Lazy updates: a popped node is contracted only if its fresh priority is still the smallest
+    std::priority_queue<std::pair<int, uint32_t>, std::vector<std::pair<int, uint32_t>>, std::greater<std::pair<int, uint32_t>>> queueNodes;
+
+    for (uint32_t node = 0; node < numNodes; ++node) {
+        queueNodes.push({contractionPriority(node, numContractedNeighbors), node});
+    }
+
+    unsigned int rank = 0;
+
+    while (queueNodes.size() > 0) {
+        uint32_t node = queueNodes.top().second;
+        queueNodes.pop();
+
+        int priority = contractionPriority(node, numContractedNeighbors);
+        if (queueNodes.size() > 0 && priority > queueNodes.top().first) {
+            queueNodes.push({priority, node});
+            continue;
+        }
+
+        stats.numShortcuts += contractNode(node, false);
+
+        contracted[node] = true;
+        ranks[node] = rank++;
+
+        for (uint32_t arcId : outArcs[node]) numContractedNeighbors[arcs[arcId].toNode] += 1;
+        for (uint32_t arcId : inArcs[node]) numContractedNeighbors[arcs[arcId].frNode] += 1;
+    }
+}
+
+
+
+uint32_t ContractionHierarchyPropagation::addNode(uint32_t nodeId) {
+    uint32_t node = indexToNode.size();
+
+    nodeToIndex[nodeId] = node;
+    indexToNode.push_back(nodeId);
+    outArcs.push_back(std::vector<uint32_t>());
+    inArcs.push_back(std::vector<uint32_t>());
+
+    return node;
+}
+
+
+
+void ContractionHierarchyPropagation::addArc(uint32_t frNode, uint32_t toNode, std::unique_ptr<MulticostID> cost, const MulticostEdge* edge, const std::pair<uint32_t, uint32_t>* shortcut) {
+    for (uint32_t arcId : outArcs[frNode]) {
+        HierarchyArc& arc = arcs[arcId];
+        if (arc.toNode != toNode) continue;
+
+        // Arcs between live nodes are never the halves of a shortcut yet, so they can be replaced
+        int comp = hierarchyArray->compare(cost, arc.cost, 0);
+        if (comp > 0) return;
+        if (comp < 0) {
+            arc.cost = std::move(cost);
+            arc.edges.clear();
+            arc.shortcuts.clear();
+        }
+
+        if (edge != nullptr) arc.edges.push_back(*edge);
+        if (shortcut != nullptr) arc.shortcuts.push_back(*shortcut);
+        return;
+    }
+
+    HierarchyArc arc;
+    arc.frNode = frNode;
+    arc.toNode = toNode;
+    arc.cost = std::move(cost);
+    if (edge != nullptr) arc.edges.push_back(*edge);
+    if (shortcut != nullptr) arc.shortcuts.push_back(*shortcut);
+
+    arcs.push_back(std::move(arc));
+    outArcs[frNode].push_back(arcs.size() - 1);
+    inArcs[toNode].push_back(arcs.size() - 1);
+}
+
+
+
+unsigned int ContractionHierarchyPropagation::contractNode(uint32_t node, bool simulate) {
+    unsigned int numShortcuts = 0;
+
+    const HierarchyWeights& witnessWeights = witness.forwardWeights;
+    std::vector<std::pair<uint32_t, std::unique_ptr<MulticostID>>> candidates;
+
+    // Arcs are appended while adding shortcuts, so only indices are held across addArc
+    for (unsigned int i = 0; i < inArcs[node].size(); ++i) {
+        uint32_t inArcId = inArcs[node][i];
+        uint32_t frNode = arcs[inArcId].frNode;
+        if (contracted[frNode]) continue;
+
+        candidates.clear();
+        std::unique_ptr<MulticostID> maxCost;
+
+        for (uint32_t outArcId : outArcs[node]) {
+            uint32_t toNode = arcs[outArcId].toNode;
+            if (contracted[toNode] || toNode == frNode) continue;
+
+            std::unique_ptr<MulticostID> cost = hierarchyArray->op(arcs[inArcId].cost, arcs[outArcId].cost, 0);
+            if (!maxCost || hierarchyArray->compare(cost, maxCost, 0) > 0) maxCost = hierarchyArray->copy(cost);
+
+            candidates.push_back({outArcId, std::move(cost)});
+        }
+
+        if (candidates.size() == 0) continue;
+
+        witnessSearch(frNode, node, maxCost);
+
+        for (auto& [outArcId, cost] : candidates) {
+            uint32_t toNode = arcs[outArcId].toNode;
+
+            // Equal cost witnesses keep the shortcut so that ties are not lost
+            if (witnessWeights.contains(toNode) && hierarchyArray->compare(witnessWeights.get(toNode), cost, 0) < 0) continue;
+
+            numShortcuts += 1;
+
+            if (!simulate) {
+                std::pair<uint32_t, uint32_t> shortcut(inArcId, outArcId);
+                addArc(frNode, toNode, std::move(cost), nullptr, &shortcut);
+            }
+        }
+    }
+
+    return numShortcuts;
+}
+
+
+
+int ContractionHierarchyPropagation::contractionPriority(uint32_t node, const std::vector<int>& numContractedNeighbors) {
+    int numLiveArcs = 0;
+
+    for (uint32_t arcId : outArcs[node]) if (!contracted[arcs[arcId].toNode]) numLiveArcs++;
+    for (uint32_t arcId : inArcs[node]) if (!contracted[arcs[arcId].frNode]) numLiveArcs++;
+
+    // Edge difference plus the number of already contracted neighbors to spread the contraction
+    return static_cast<int>(contractNode(node, true)) - numLiveArcs + numContractedNeighbors[node];
+}
+
+
+
+void ContractionHierarchyPropagation::witnessSearch(uint32_t source, uint32_t excluded, const std::unique_ptr<MulticostID>& maxCost) {
+    IMulticostArray& multicostArray = *hierarchyArray;
+
+    Heap<std::unique_ptr<MulticostID>, FirstMonoidOrder>& heap = witness.heap;
+    HierarchyWeights& weights = witness.forwardWeights;
+
+    heap.clear();
+    heap.set_compare(FirstMonoidOrder{&multicostArray});
+    weights.clear(indexToNode.size());
+
+    heap.push(multicostArray.identity(), source);
+
+    unsigned int numSettled = 0;
+
+    while (heap.get_size() > 0 && numSettled < WITNESS_SETTLE_LIMIT) {
+        std::unique_ptr<MulticostID> cost = heap.top_item();
+        uint32_t node = heap.top_item_id();
+        heap.pop();
+
+        if (multicostArray.compare(cost, maxCost, 0) > 0) break;
+
+        for (uint32_t arcId : outArcs[node]) {
+            uint32_t toNode = arcs[arcId].toNode;
+            if (toNode == excluded || contracted[toNode] || weights.contains(toNode)) continue;
+
+            heap.push(multicostArray.op(cost, arcs[arcId].cost, 0), toNode);
+        }
+
+        weights.set(node, std::move(cost));
+        numSettled += 1;
+    }
+}
+
+
+
+bool ContractionHierarchyPropagation::upwardSearch(uint32_t source, bool isForward, HierarchySearch& search, HierarchyWeights& weights, QueryCancellation& cancellation) {
+    IMulticostArray& multicostArray = *hierarchyArray;
+
+    Heap<std::unique_ptr<MulticostID>, FirstMonoidOrder>& heap = search.heap;
+
+    heap.clear();
+    heap.set_compare(FirstMonoidOrder{&multicostArray});
+    weights.clear(indexToNode.size());
+
+    heap.push(multicostArray.identity(), source);
+
+    while (heap.get_size() > 0) {
+        if (cancellation.isCancelled()) return false;
+
+        std::unique_ptr<MulticostID> cost = heap.top_item();
+        uint32_t node = heap.top_item_id();
+        heap.pop();
+
+        const std::vector<uint32_t>& nodeArcs = isForward ? outArcs[node] : inArcs[node];
+
+        for (uint32_t arcId : nodeArcs) {
+            uint32_t nextNode = isForward ? arcs[arcId].toNode : arcs[arcId].frNode;
+            if (ranks[nextNode] < ranks[node] || weights.contains(nextNode)) continue;
+
+            heap.push(multicostArray.op(cost, arcs[arcId].cost, 0), nextNode);
+        }
+
+        weights.set(node, std::move(cost));
+    }
+
+    return true;
+}
+
+
+
+void ContractionHierarchyPropagation::addUnpackedEdges(uint32_t arcId, HierarchySearch& search, OptimalSubgraph& optimalSubgraph) {
+    std::vector<uint32_t>& stack = search.arcStack;
+    stack.clear();
+
+    if (!search.unpackedArcs.contains(arcId)) {
+        search.unpackedArcs.insert(arcId);
+        stack.push_back(arcId);
+    }
+
+    while (stack.size() > 0) {
+        const HierarchyArc& arc = arcs[stack.back()];
+        stack.pop_back();
+
+        for (const MulticostEdge& edge : arc.edges) {
+            if (search.addedEdges.contains(edge.edgeCostId)) continue;
+            search.addedEdges.insert(edge.edgeCostId);
+            optimalSubgraph.addOptimalEdge(indexToNode[arc.frNode], edge);
+        }
+
+        for (const std::pair<uint32_t, uint32_t>& shortcut : arc.shortcuts) {
+            for (uint32_t halfArcId : {shortcut.first, shortcut.second}) {
+                if (search.unpackedArcs.contains(halfArcId)) continue;
+                search.unpackedArcs.insert(halfArcId);
+                stack.push_back(halfArcId);
+            }
+        }
+    }
+}
+
+
+
+ContractionHierarchyPropagation::HierarchySearch& ContractionHierarchyPropagation::threadSearch() {
+    thread_local HierarchySearch search;
+    return search;
+}
+
+
+
+void ContractionHierarchyPropagation::recordPredecessors(OptimalSubgraph& optimalSubgraph, uint32_t start, QueryWorkspace& workspace) {
+    VisitedSet& closed = workspace.getClosed();
+    closed.clear();
+
+    std::queue<uint32_t> queueNodes;
+    queueNodes.push(start);
+    closed.insert(start);
+    workspace.setPredecessor(start, start);
+
+    while (queueNodes.size() > 0) {
+        uint32_t nodeId = queueNodes.front();
+        queueNodes.pop();
+
+        for (const MulticostEdge& edge : optimalSubgraph.getOptimalNextEdges(nodeId)) {
+            if (closed.contains(edge.nodeId)) continue;
+
+            closed.insert(edge.nodeId);
+            workspace.setPredecessor(edge.nodeId, nodeId);
+            queueNodes.push(edge.nodeId);
+        }
+    }
+}
@@ -1,100 +1,123 @@
 #include "../../include/multicost_array.hpp"
 #include "../../include/multicost_graph.hpp"
 #include "../../include/heap.hpp"
+#include "../../include/query_workspace.hpp"
+#include "../../include/visited_set.hpp"
 
 #include "../../include/iterated_dijkstra_propagation.hpp"
 
+#include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <memory>
-#include <queue>
-#include <set>
-#include <unordered_map>
 #include <vector>
 
 
 std::vector<uint32_t> IteratedDijkstraPropagation::getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end) {
-    OptimalSubgraph optimalSubgraph = this->optimalSubgraph(graph, multicostArray, start, end);
+    QueryCancellation noCancellation;
+    QueryProgress progress;
+    return getOptimalPath(graph, multicostArray, start, end, noCancellation, progress);
+}
 
-    if (!optimalSubgraph.isGraphExists()) return std::vector<uint32_t>();
 
-    std::unordered_map<uint32_t, uint32_t> parent;
-    std::vector<uint32_t> queueNodes;
-    std::set<uint32_t> closed;
-    queueNodes.push_back(end);
-    closed.insert(end);
 
-    while(queueNodes.size() > 0) {
-        uint32_t currentNodeId = queueNodes.back();
+std::vector<uint32_t> IteratedDijkstraPropagation::getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryCancellation& cancellation, QueryProgress& progress) {
+    std::vector<uint32_t> optimalPath;
+    getOptimalPath(graph, multicostArray, start, end, optimalPath, cancellation, progress);
+    return optimalPath;
+}
 
-        queueNodes.pop_back();
-    
-        const std::vector<MulticostEdge>& edges = optimalSubgraph.getOptimalPrevEdges(currentNodeId);
 
-        bool startFound = false;
-        for (const MulticostEdge edge : edges) {
-            if (closed.find(edge.frNodeId) == closed.end()) {
-                queueNodes.push_back(edge.frNodeId);
-                closed.insert(edge.frNodeId);
-            }
 
-            parent[edge.frNodeId] = currentNodeId;
-            
-            if (edge.frNodeId == start) {
-                startFound = true;
-                break;
-            }
-        }
-        if (startFound) break;
+void IteratedDijkstraPropagation::getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, std::vector<uint32_t>& path, QueryCancellation& cancellation, QueryProgress& progress) {
+    getOptimalPath(graph, multicostArray, start, end, path, threadWorkspace(), cancellation, progress);
+}
+
+
+
+void IteratedDijkstraPropagation::getOptimalPath(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, std::vector<uint32_t>& path, QueryWorkspace& workspace, QueryCancellation& cancellation, QueryProgress& progress) {
+    path.clear();
+
+    if (multicostArray->is_lexicographic()) {
+        progress.numMonoidsOptimal = 0;
+        progress.numMonoidsSkipped = 0;
+        progress.isComplete = false;
+
+        if (!lexicographicDijkstra(graph, multicostArray, start, end, workspace, cancellation)) return;
+
+        progress.isComplete = true;
+        if (!workspace.getClosed().contains(end)) return;
+        
+        progress.numMonoidsOptimal = multicostArray->num_monoids();
+        extractPath(start, end, workspace, path);
+        return;
     }
 
-    std::vector<uint32_t> optimalPath;
+    OptimalSubgraph& optimalSubgraph = this->optimalSubgraph(graph, multicostArray, start, end, workspace, cancellation, progress);
+
+    if (!optimalSubgraph.isGraphExists()) return;
+
+    // The predecessors of the last bfs form a tree of optimal edges rooted at start
+    extractPath(start, end, workspace, path);
+}
+
 
-    uint32_t nextNodeId = parent[start];
-    optimalPath.push_back(start);
-    while (nextNodeId != end) {
-        optimalPath.push_back(nextNodeId);
-        nextNodeId = parent[nextNodeId];
+
+void IteratedDijkstraPropagation::extractPath(uint32_t start, uint32_t end, QueryWorkspace& workspace, std::vector<uint32_t>& path) {
+    unsigned int pathLength = 1;
+    for (uint32_t nodeId = end; nodeId != start; nodeId = workspace.getPredecessor(nodeId)) {
+        pathLength++;
     }
-    optimalPath.push_back(end);
 
-    return optimalPath;
+    path.resize(pathLength);
+
+    uint32_t nodeId = end;
+    for (unsigned int i = pathLength; i > 0; --i) {
+        path[i - 1] = nodeId;
+        nodeId = workspace.getPredecessor(nodeId);
+    }
 }
 
 
 
 std::vector<uint32_t> IteratedDijkstraPropagation::getOptimalEdges(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end) {
-    OptimalSubgraph optimalSubgraph = this->optimalSubgraph(graph, multicostArray, start, end);
-   
-    std::vector<uint32_t> optimalEdges;
+    QueryCancellation noCancellation;
+    QueryProgress progress;
+    return getOptimalEdges(graph, multicostArray, start, end, noCancellation, progress);
+}
+
 
-    for (const MulticostEdge edge : optimalSubgraph.getOptimalEdges()) {
-        optimalEdges.push_back(edge.frNodeId);
-        optimalEdges.push_back(edge.toNodeId);
-    }
 
-    return optimalEdges;
+std::vector<uint32_t> IteratedDijkstraPropagation::getOptimalEdges(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryCancellation& cancellation, QueryProgress& progress) {
+    OptimalSubgraph& optimalSubgraph = this->optimalSubgraph(graph, multicostArray, start, end, threadWorkspace(), cancellation, progress);
+   
+    return optimalSubgraph.getOptimalEdges();
 }
 
 
 
-void IteratedDijkstraPropagation::forwardDijkstra(OptimalSubgraph& optimalGraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t source, unsigned int monoidIndex) {
-    auto heap = Heap<std::unique_ptr<MulticostID>> (
-        [multicostArray, monoidIndex](const std::unique_ptr<MulticostID>& a, const std::unique_ptr<MulticostID>& b){ 
-            return !(multicostArray->compare(a, b, monoidIndex) < 0); 
-        }
-    );
+bool IteratedDijkstraPropagation::forwardDijkstra(OptimalSubgraph& optimalGraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t source, uint32_t target, unsigned int monoidIndex, QueryWorkspace& workspace, QueryCancellation& cancellation) {
+    Heap<SearchCost>& heap = workspace.getHeap(*multicostArray, monoidIndex);
     
-    std::set<uint32_t> closed;
+    VisitedSet& closed = workspace.getClosed();
+    closed.clear();
 
-    heap.push(std::move(multicostArray->identity()), source);
+    std::unique_ptr<MulticostID> lowerBound = multicostArray->identity();
+    std::unique_ptr<MulticostID> targetWeight;
 
-    while (heap.get_size() > 0) {
+    heap.push(makeSearchCost(*multicostArray, multicostArray->identity(), source, target, monoidIndex, lowerBound), source);
 
+    while (heap.get_size() > 0) {
+        if (cancellation.isCancelled()) return false;
 
-        std::unique_ptr<MulticostID> cost = heap.top_item();
+        SearchCost cost = heap.top_item();
         uint32_t id = heap.top_item_id();
         heap.pop();
 
+        // With a heuristic, nodes whose bound exceeds the optimal cost of target are not on an optimal path
+        if (targetWeight && compareMonoid(*multicostArray, cost.key(), targetWeight, monoidIndex) > 0) break;
+        if (heuristic && id == target) targetWeight = multicostArray->copy(cost.weight);
+
         closed.insert(id);
         
         std::vector<MulticostEdge>& nextEdges = optimalGraph.getOptimalNextEdges(id, monoidIndex);
@@ -102,47 +125,55 @@ void IteratedDijkstraPropagation::forwardDijkstra(OptimalSubgraph& optimalGraph,
         for (int i = 0; i < nextEdges.size(); ++i) {
             const std::unique_ptr<MulticostID>& edgeCost = optimalGraph.getEdgeCost(nextEdges[i].edgeCostId);
 
-            if (closed.find(nextEdges[i].toNodeId) == closed.end()) {
-                std::unique_ptr<MulticostID> weight = multicostArray->op(cost, edgeCost, monoidIndex);
+            if (!closed.contains(nextEdges[i].nodeId)) {
+                std::unique_ptr<MulticostID> weight = opMonoid(*multicostArray, cost.weight, edgeCost, monoidIndex);
                 
-                bool success = heap.push(std::move(weight), nextEdges[i].toNodeId);
+                bool success = heap.push(makeSearchCost(*multicostArray, std::move(weight), nextEdges[i].nodeId, target, monoidIndex, lowerBound), nextEdges[i].nodeId);
                 
                 if (success) {
-                    optimalGraph.addTempNextEdge(nextEdges[i]);
+                    optimalGraph.addTempNextEdge(id, nextEdges[i]);
                 }
             } 
             else {
                 // Going back does not incur additional costs
-                if (multicostArray->is_identity(edgeCost, monoidIndex)) {
-                    optimalGraph.addTempNextEdge(nextEdges[i]);
+                // With a heuristic, a node can also be closed before a predecessor of equal priority
+                if (isIdentityMonoid(*multicostArray, edgeCost, monoidIndex) || 
+                    (heuristic && !optimalGraph.isNextWeightInf(nextEdges[i].nodeId) && isTightEdge(*multicostArray, cost.weight, edgeCost, optimalGraph.getNextWeight(nextEdges[i].nodeId), monoidIndex))) {
+                    optimalGraph.addTempNextEdge(id, nextEdges[i]);
                 } 
             }
         }
         
-        optimalGraph.setNextWeight(id, std::move(cost));
+        optimalGraph.setNextWeight(id, std::move(cost.weight));
     }
+
+    return true;
 };
 
 
 
-void IteratedDijkstraPropagation::backwardDijkstra(OptimalSubgraph& optimalGraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t source, unsigned int monoidIndex) {
-    auto heap = Heap<std::unique_ptr<MulticostID>> (
-        [multicostArray, monoidIndex](const std::unique_ptr<MulticostID>& a, const std::unique_ptr<MulticostID>& b){ 
-            return !(multicostArray->compare(a, b, monoidIndex) < 0); 
-        }
-    );
+bool IteratedDijkstraPropagation::backwardDijkstra(OptimalSubgraph& optimalGraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t source, uint32_t target, unsigned int monoidIndex, QueryWorkspace& workspace, QueryCancellation& cancellation) {
+    Heap<SearchCost>& heap = workspace.getHeap(*multicostArray, monoidIndex);
 
-    std::set<uint32_t> closed;
+    VisitedSet& closed = workspace.getClosed();
+    closed.clear();
 
-    heap.push(std::move(multicostArray->identity()), source);
+    std::unique_ptr<MulticostID> lowerBound = multicostArray->identity();
+    std::unique_ptr<MulticostID> targetWeight;
 
-    while (heap.get_size() > 0) {
+    heap.push(makeSearchCost(*multicostArray, multicostArray->identity(), target, source, monoidIndex, lowerBound), source);
 
+    while (heap.get_size() > 0) {
+        if (cancellation.isCancelled()) return false;
 
-        std::unique_ptr<MulticostID> cost = heap.top_item();
+        SearchCost cost = heap.top_item();
         uint32_t id = heap.top_item_id();
         heap.pop();
 
+        // With a heuristic, nodes whose bound exceeds the optimal cost of target are not on an optimal path
+        if (targetWeight && compareMonoid(*multicostArray, cost.key(), targetWeight, monoidIndex) > 0) break;
+        if (heuristic && id == target) targetWeight = multicostArray->copy(cost.weight);
+
         closed.insert(id);
         
         std::vector<MulticostEdge>& prevEdges = optimalGraph.getOptimalPrevEdges(id, monoidIndex);
@@ -150,81 +181,395 @@ void IteratedDijkstraPropagation::backwardDijkstra(OptimalSubgraph& optimalGraph
         for (int i = 0; i < prevEdges.size(); ++i) {
             const std::unique_ptr<MulticostID>& edgeCost = optimalGraph.getEdgeCost(prevEdges[i].edgeCostId);
 
-            if (closed.find(prevEdges[i].frNodeId) == closed.end()) {
+            if (!closed.contains(prevEdges[i].nodeId)) {
     
-                std::unique_ptr<MulticostID> weight = multicostArray->op(cost, edgeCost, monoidIndex);
+                std::unique_ptr<MulticostID> weight = opMonoid(*multicostArray, cost.weight, edgeCost, monoidIndex);
 
-                bool success = heap.push(std::move(weight), prevEdges[i].frNodeId);
+                bool success = heap.push(makeSearchCost(*multicostArray, std::move(weight), target, prevEdges[i].nodeId, monoidIndex, lowerBound), prevEdges[i].nodeId);
                 
                 if (success) {
-                    optimalGraph.addTempPrevEdge(prevEdges[i]);
+                    optimalGraph.addTempPrevEdge(id, prevEdges[i]);
                 }
             } 
             else {
                 // Going back does not incur additional costs
-                if (multicostArray->is_identity(edgeCost, monoidIndex)) {
-                    optimalGraph.addTempPrevEdge(prevEdges[i]);
+                // With a heuristic, a node can also be closed before a predecessor of equal priority
+                if (isIdentityMonoid(*multicostArray, edgeCost, monoidIndex) || 
+                    (heuristic && !optimalGraph.isPrevWeightInf(prevEdges[i].nodeId) && isTightEdge(*multicostArray, cost.weight, edgeCost, optimalGraph.getPrevWeight(prevEdges[i].nodeId), monoidIndex))) {
+                    optimalGraph.addTempPrevEdge(id, prevEdges[i]);
                 } 
             }
         }
         
-        optimalGraph.setPrevWeight(id, std::move(cost));
+        optimalGraph.setPrevWeight(id, std::move(cost.weight));
     }
+
+    return true;
 };
 
 
-void IteratedDijkstraPropagation::bfsOptimalEdgeRetrieval(OptimalSubgraph& optimalSubgraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, unsigned int monoidIndex) {
-    const std::unique_ptr<MulticostID>& optimalCost = optimalSubgraph.getPrevWeight(start);
-   
-    std::unordered_map<uint32_t, std::vector<MulticostEdge>>& tempNextEdges = optimalSubgraph.getTempNextEdges();
-    std::unordered_map<uint32_t, std::vector<MulticostEdge>>& tempPrevEdges = optimalSubgraph.getTempPrevEdges();
+bool IteratedDijkstraPropagation::lexicographicDijkstra(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryWorkspace& workspace, QueryCancellation& cancellation) {
+    Heap<SearchCost>& heap = workspace.getHeap(*multicostArray, IMulticostGraph::ALL_MONOIDS);
+
+    VisitedSet& closed = workspace.getClosed();
+    closed.clear();
+
+    std::unique_ptr<MulticostID> lowerBound = multicostArray->identity();
+
+    heap.push(makeSearchCost(*multicostArray, multicostArray->identity(), start, end, IMulticostGraph::ALL_MONOIDS, lowerBound), start);
+    workspace.setPredecessor(start, start);
+
+    while (heap.get_size() > 0) {
+        if (cancellation.isCancelled()) return false;
+
+        SearchCost cost = heap.top_item();
+        uint32_t id = heap.top_item_id();
+        heap.pop();
+
+        closed.insert(id);
+
+        // Lexicographic costs are final once popped
+        if (id == end) return true;
+
+        std::vector<MulticostEdge>& nextEdges = graph.getNextEdges(id, IMulticostGraph::ALL_MONOIDS);
+
+        for (const MulticostEdge& edge : nextEdges) {
+            if (closed.contains(edge.nodeId)) continue;
+
+            std::unique_ptr<MulticostID> weight = multicostArray->op(cost.weight, graph.getEdgeCost(edge.edgeCostId));
+
+            if (heap.push(makeSearchCost(*multicostArray, std::move(weight), edge.nodeId, end, IMulticostGraph::ALL_MONOIDS, lowerBound), edge.nodeId)) {
+                workspace.setPredecessor(edge.nodeId, id);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+
+bool IteratedDijkstraPropagation::isDeltaStepping(IMulticostArray& multicostArray, unsigned int monoidIndex) {
+    // Goal directed searches and whole multicost passes need the heap order
+    if (!deltaStepping || heuristic || monoidIndex == IMulticostGraph::ALL_MONOIDS) return false;
+
+    // Buckets are only exact when distances grow by non-negative sums
+    if (!multicostArray.is_additive(monoidIndex)) return false;
+
+    double value;
+    return multicostArray.get_numeric(multicostArray.identity(), monoidIndex, value);
+}
+
+
+
+bool IteratedDijkstraPropagation::deltaSteppingDijkstra(OptimalSubgraph& optimalGraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t source, unsigned int monoidIndex, bool isForward, QueryWorkspace& workspace, QueryCancellation& cancellation) {
+    using RelaxEdge = DeltaSteppingBuffers::RelaxEdge;
+    using Request = DeltaSteppingBuffers::Request;
+
+    const double delta = deltaStepping->delta;
+    const double infinity = std::numeric_limits<double>::infinity();
+    const unsigned int noEdge = std::numeric_limits<unsigned int>::max();
+
+    // Node ids index every array, they are dense like the ids of VisitedSet
+    DeltaSteppingBuffers& buffers = workspace.getDeltaSteppingBuffers();
+    std::vector<double>& distances = buffers.distances;
+    std::vector<unsigned int>& predecessorEdges = buffers.predecessorEdges;
+    std::vector<bool>& expanded = buffers.expanded;
+    std::vector<bool>& inFrontier = buffers.inFrontier;
+    std::vector<bool>& inSettled = buffers.inSettled;
+
+    std::vector<RelaxEdge>& edges = buffers.edges;
+    std::vector<unsigned int>& edgesBegin = buffers.edgesBegin;
+    std::vector<unsigned int>& edgesEnd = buffers.edgesEnd;
+
+    buffers.known.clear();
+    edges.clear();
+
+    // Only called from the calling thread, so the relax phases never see the arrays move
+    auto addNode = [&](uint32_t node) {
+        if (node >= distances.size()) {
+            size_t size = std::max<size_t>(distances.size() * 2, static_cast<size_t>(node) + 1);
+            distances.resize(size);
+            predecessorEdges.resize(size);
+            expanded.resize(size);
+            inFrontier.resize(size);
+            inSettled.resize(size);
+            edgesBegin.resize(size);
+            edgesEnd.resize(size);
+        }
+
+        // Entries left by the previous passes are reset on the first touch of this one
+        if (buffers.known.contains(node)) return;
+        buffers.known.insert(node);
+
+        distances[node] = infinity;
+        predecessorEdges[node] = noEdge;
+        expanded[node] = false;
+        inFrontier[node] = false;
+        inSettled[node] = false;
+    };
+
+    auto expand = [&](uint32_t node) {
+        if (expanded[node]) return;
+        expanded[node] = true;
+
+        std::vector<MulticostEdge>& graphEdges = isForward ?
+            optimalGraph.getOptimalNextEdges(node, monoidIndex) :
+            optimalGraph.getOptimalPrevEdges(node, monoidIndex);
+
+        edgesBegin[node] = edges.size();
+        for (const MulticostEdge& edge : graphEdges) {
+            RelaxEdge relaxEdge;
+            relaxEdge.edge = edge;
+            multicostArray->get_numeric(optimalGraph.getEdgeCost(edge.edgeCostId), monoidIndex, relaxEdge.cost);
+            relaxEdge.frNode = node;
+            relaxEdge.toNode = edge.nodeId;
+            addNode(edge.nodeId);
+            edges.push_back(relaxEdge);
+        }
+        edgesEnd[node] = edges.size();
+    };
+
+    // Ring of buckets, bucket b is in slot b % buckets.size() while b is within the ring of currentBucket
+    // Nodes are left in their old buckets when improved, and skipped there by their distance
+    std::vector<std::vector<uint32_t>>& buckets = buffers.buckets;
+    if (buckets.empty()) buckets.resize(16);
+    for (std::vector<uint32_t>& bucket : buckets) bucket.clear();
+
+    uint64_t currentBucket = 0;
+    size_t numBucketed = 0;
+
+    auto bucketOf = [delta](double distance) {
+        return static_cast<uint64_t>(std::max(distance, 0.0) / delta);
+    };
+
+    auto addToBucket = [&](uint32_t node) {
+        uint64_t bucket = bucketOf(distances[node]);
+
+        if (bucket - currentBucket >= buckets.size()) {
+            size_t size = buckets.size();
+            while (bucket - currentBucket >= size) size *= 2;
+
+            std::vector<std::vector<uint32_t>> oldBuckets(size);
+            std::swap(buckets, oldBuckets);
+            numBucketed = 0;
+
+            for (std::vector<uint32_t>& oldBucket : oldBuckets) {
+                for (uint32_t oldNode : oldBucket) {
+                    buckets[bucketOf(distances[oldNode]) % size].push_back(oldNode);
+                    numBucketed++;
+                }
+            }
+        }
 
+        buckets[bucket % buckets.size()].push_back(node);
+        numBucketed++;
+    };
+
+    // Partitioned relaxation: task t gathers the requests of its share of nodes by the partition of
+    // their target, then task p applies the requests targeting partition p, so no two tasks write
+    // the same node. Accepted requests are bucketed afterwards on the calling thread
+    unsigned int maxTasks = workerPool->getNumThreads();
+    std::vector<std::vector<Request>>& requests = buffers.requests;
+    std::vector<std::vector<uint32_t>>& improvedNodes = buffers.improvedNodes;
+    if (requests.size() < maxTasks * maxTasks) requests.resize(maxTasks * maxTasks);
+    if (improvedNodes.size() < maxTasks) improvedNodes.resize(maxTasks);
+
+    auto relax = [&](const std::vector<uint32_t>& nodes, bool isLight) {
+        unsigned int numTasks = std::max(1u, std::min(maxTasks, static_cast<unsigned int>(nodes.size() / PARALLEL_NODES_PER_THREAD)));
+        unsigned int chunk = (nodes.size() + numTasks - 1) / numTasks;
+
+        auto gather = [&](unsigned int task) {
+            for (unsigned int p = 0; p < numTasks; ++p) requests[task * numTasks + p].clear();
+
+            unsigned int begin = std::min<unsigned int>(task * chunk, nodes.size());
+            unsigned int end = std::min<unsigned int>(begin + chunk, nodes.size());
+
+            for (unsigned int i = begin; i < end; ++i) {
+                uint32_t node = nodes[i];
+                for (unsigned int e = edgesBegin[node]; e < edgesEnd[node]; ++e) {
+                    const RelaxEdge& relaxEdge = edges[e];
+                    if ((relaxEdge.cost <= delta) != isLight) continue;
+
+                    double distance = distances[node] + relaxEdge.cost;
+                    if (distance < distances[relaxEdge.toNode]) {
+                        requests[task * numTasks + relaxEdge.toNode % numTasks].push_back({relaxEdge.toNode, distance, e});
+                    }
+                }
+            }
+        };
+
+        auto apply = [&](unsigned int partition) {
+            improvedNodes[partition].clear();
+
+            for (unsigned int task = 0; task < numTasks; ++task) {
+                for (const Request& request : requests[task * numTasks + partition]) {
+                    if (!(request.distance < distances[request.toNode])) continue;
+
+                    distances[request.toNode] = request.distance;
+                    predecessorEdges[request.toNode] = request.edgeIndex;
+                    improvedNodes[partition].push_back(request.toNode);
+                }
+            }
+        };
+
+        // The pool takes a std::function, a single reference keeps it in its small buffer
+        if (numTasks == 1) {
+            gather(0);
+            apply(0);
+        } else {
+            workerPool->run(numTasks, [&gather](unsigned int task) { gather(task); });
+            workerPool->run(numTasks, [&apply](unsigned int task) { apply(task); });
+        }
+
+        for (unsigned int partition = 0; partition < numTasks; ++partition) {
+            for (uint32_t node : improvedNodes[partition]) addToBucket(node);
+        }
+    };
+
+    std::unique_ptr<MulticostID> identity = multicostArray->identity();
+
+    addNode(source);
+    multicostArray->get_numeric(identity, monoidIndex, distances[source]);
+    currentBucket = bucketOf(distances[source]);
+    addToBucket(source);
+
+    std::vector<uint32_t>& expandOrder = buffers.expandOrder;
+    std::vector<uint32_t>& bucketNodes = buffers.bucketNodes;
+    std::vector<uint32_t>& frontier = buffers.frontier;
+    std::vector<uint32_t>& settled = buffers.settled;
+    expandOrder.clear();
+
+    while (numBucketed > 0) {
+        while (buckets[currentBucket % buckets.size()].empty()) currentBucket++;
+        settled.clear();
+
+        // Light edges can refill the current bucket
+        while (!buckets[currentBucket % buckets.size()].empty()) {
+            if (cancellation.isCancelled()) return false;
+
+            std::vector<uint32_t>& bucket = buckets[currentBucket % buckets.size()];
+            // Copied rather than swapped, so every slot keeps its own capacity for the next queries
+            bucketNodes.assign(bucket.begin(), bucket.end());
+            bucket.clear();
+            numBucketed -= bucketNodes.size();
+
+            // Expanding adds nodes, every one of them is known before the relaxation
+            for (uint32_t node : bucketNodes) {
+                if (!expanded[node]) expandOrder.push_back(node);
+                expand(node);
+            }
+
+            frontier.clear();
+
+            for (uint32_t node : bucketNodes) {
+                if (inFrontier[node] || bucketOf(distances[node]) != currentBucket) continue;
+                inFrontier[node] = true;
+                frontier.push_back(node);
+
+                if (!inSettled[node]) {
+                    inSettled[node] = true;
+                    settled.push_back(node);
+                }
+            }
+
+            for (uint32_t node : frontier) inFrontier[node] = false;
+
+            relax(frontier, true);
+        }
+
+        // Heavy edges always land in a later bucket
+        relax(settled, false);
+        for (uint32_t node : settled) inSettled[node] = false;
+    }
+
+    // Weights follow the predecessor edges in the monoid itself, in order of increasing distance
+    std::sort(expandOrder.begin(), expandOrder.end(), [&](uint32_t a, uint32_t b) { return distances[a] < distances[b]; });
+
+    std::vector<std::unique_ptr<MulticostID>>& weights = buffers.weights;
+    if (weights.size() < distances.size()) weights.resize(distances.size());
+    weights[source] = multicostArray->copy(identity);
+
+    std::vector<uint32_t>& chain = buffers.chain;
+    chain.clear();
+    for (uint32_t node : expandOrder) {
+        // Zero cost predecessors can share the distance, resolve them first
+        for (uint32_t n = node; !weights[n]; n = edges[predecessorEdges[n]].frNode) chain.push_back(n);
+
+        while (chain.size() > 0) {
+            uint32_t n = chain.back();
+            chain.pop_back();
+
+            const RelaxEdge& relaxEdge = edges[predecessorEdges[n]];
+            weights[n] = opMonoid(*multicostArray, weights[relaxEdge.frNode], optimalGraph.getEdgeCost(relaxEdge.edge.edgeCostId), monoidIndex);
+        }
+    }
+
+    for (uint32_t node : expandOrder) {
+        for (unsigned int e = edgesBegin[node]; e < edgesEnd[node]; ++e) {
+            const RelaxEdge& relaxEdge = edges[e];
+            if (!weights[relaxEdge.toNode]) continue;
+
+            if (isTightEdge(*multicostArray, weights[node], optimalGraph.getEdgeCost(relaxEdge.edge.edgeCostId), weights[relaxEdge.toNode], monoidIndex)) {
+                if (isForward) {
+                    optimalGraph.addTempNextEdge(node, relaxEdge.edge);
+                } else {
+                    optimalGraph.addTempPrevEdge(node, relaxEdge.edge);
+                }
+            }
+        }
+    }
+
+    for (uint32_t node : expandOrder) {
+        if (isForward) {
+            optimalGraph.setNextWeight(node, std::move(weights[node]));
+        } else {
+            optimalGraph.setPrevWeight(node, std::move(weights[node]));
+        }
+    }
+
+    return true;
+}
+
+
+
+void IteratedDijkstraPropagation::bfsOptimalEdgeRetrieval(OptimalSubgraph& optimalSubgraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, unsigned int monoidIndex, QueryWorkspace& workspace) {
+    const std::unique_ptr<MulticostID>& optimalCost = optimalSubgraph.getPrevWeight(start);
 
-    std::queue<uint32_t> queueNodes;
-    std::set<uint32_t> closed;
-    queueNodes.push(start);
+    std::vector<uint32_t>& queueNodes = workspace.getQueue();
+    VisitedSet& closed = workspace.getClosed();
+    closed.clear();
+    queueNodes.push_back(start);
     closed.insert(start);
+    workspace.setPredecessor(start, start);
 
     std::unique_ptr<MulticostID> totalCost = multicostArray->identity();
 
-    while(queueNodes.size() > 0) {
-        uint32_t nodeId = queueNodes.front();
-        queueNodes.pop();
+    for (unsigned int queueFront = 0; queueFront < queueNodes.size(); ++queueFront) {
+        uint32_t nodeId = queueNodes[queueFront];
 
         const std::unique_ptr<MulticostID>& nextWeight = optimalSubgraph.getNextWeight(nodeId);
 
-        std::vector<MulticostEdge>& nextEdges = tempNextEdges[nodeId];
+        std::vector<MulticostEdge>& nextEdges = optimalSubgraph.getTempNextEdges(nodeId);
 
         for (const MulticostEdge edge : nextEdges) {
-            if (optimalSubgraph.isPrevWeightInf(edge.toNodeId)) {
+            if (optimalSubgraph.isPrevWeightInf(edge.nodeId)) {
                 continue;
             }
 
-            const std::unique_ptr<MulticostID>& prevWeight = optimalSubgraph.getPrevWeight(edge.toNodeId);
+            const std::unique_ptr<MulticostID>& prevWeight = optimalSubgraph.getPrevWeight(edge.nodeId);
             const std::unique_ptr<MulticostID>& edgeCost = optimalSubgraph.getEdgeCost(edge.edgeCostId);
 
-            // TESTING TESTING TESTING
-            // auto mArray = std::dynamic_pointer_cast<MonoMulticostArray<int, 2>>(multicostArray);
-            // auto nextCostTest = mArray->get_values(nextWeight);
-            // auto prevCostTest = mArray->get_values(prevWeight);
-            // auto edgeCostTest = mArray->get_values(edgeCost);
-            // auto optmCostTest = mArray->get_values(optimalCost);
-            // std::printf("%s {%d, %d}\n", "n", nextCostTest[0], nextCostTest[1]);
-            // std::printf("%s {%d, %d}\n", "p", prevCostTest[0], prevCostTest[1]);
-            // std::printf("%s {%d, %d}\n", "e", edgeCostTest[0], edgeCostTest[1]);
-            // std::printf("%s {%d, %d}\n", "o", optmCostTest[0], optmCostTest[1]);
-
-
-            multicostArray->op(prevWeight, nextWeight, totalCost, monoidIndex);
-            multicostArray->op(edgeCost, totalCost, totalCost, monoidIndex);
+            opMonoid(*multicostArray, prevWeight, nextWeight, totalCost, monoidIndex);
+            opMonoid(*multicostArray, edgeCost, totalCost, totalCost, monoidIndex);
 
+            if (compareMonoid(*multicostArray, totalCost, optimalCost, monoidIndex) == 0) {
+                optimalSubgraph.addOptimalEdge(nodeId, edge);
 
-            if (multicostArray->compare(totalCost, optimalCost, monoidIndex) == 0) {
-                optimalSubgraph.addOptimalEdge(edge);
-
-                if (closed.find(edge.toNodeId) == closed.end()) {
-                    queueNodes.push(edge.toNodeId);
-                    closed.insert(edge.toNodeId);
+                if (!closed.contains(edge.nodeId)) {
+                    queueNodes.push_back(edge.nodeId);
+                    closed.insert(edge.nodeId);
+                    workspace.setPredecessor(edge.nodeId, nodeId);
                 }
             }
         }
@@ -235,42 +580,131 @@ void IteratedDijkstraPropagation::bfsOptimalEdgeRetrieval(OptimalSubgraph& optim
 
 
 
-void IteratedDijkstraPropagation::iterate(OptimalSubgraph& optimalSubgraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, unsigned int index) {
+bool IteratedDijkstraPropagation::iterate(OptimalSubgraph& optimalSubgraph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, unsigned int index, QueryWorkspace& workspace, QueryCancellation& cancellation) {
 
     optimalSubgraph.clearPropagationEdges();
     optimalSubgraph.clearWeights();
 
-    forwardDijkstra(optimalSubgraph, multicostArray, start, index);
-    if (optimalSubgraph.isNextWeightInf(end)) return;
+    if (isDeltaStepping(*multicostArray, index)) {
+        if (!deltaSteppingDijkstra(optimalSubgraph, multicostArray, start, index, true, workspace, cancellation)) return false;
+        if (optimalSubgraph.isNextWeightInf(end)) return true;
+
+        if (!deltaSteppingDijkstra(optimalSubgraph, multicostArray, end, index, false, workspace, cancellation)) return false;
+        if (optimalSubgraph.isPrevWeightInf(start)) return true;
+    } else {
+        if (!forwardDijkstra(optimalSubgraph, multicostArray, start, end, index, workspace, cancellation)) return false;
+        if (optimalSubgraph.isNextWeightInf(end)) return true;
 
-    backwardDijkstra(optimalSubgraph, multicostArray, end, index);    
-    if (optimalSubgraph.isPrevWeightInf(start)) return;
+        if (!backwardDijkstra(optimalSubgraph, multicostArray, end, start, index, workspace, cancellation)) return false;
+        if (optimalSubgraph.isPrevWeightInf(start)) return true;
+    }
 
+    // The bfs runs to completion once started, it is linear in the size of the temp edges
     optimalSubgraph.clearOptimalEdges();
 
-    bfsOptimalEdgeRetrieval(optimalSubgraph, multicostArray, start, index);
+    bfsOptimalEdgeRetrieval(optimalSubgraph, multicostArray, start, index, workspace);
 
     optimalSubgraph.notInitial();
+
+    return true;
 }
 
 
-OptimalSubgraph
-IteratedDijkstraPropagation::optimalSubgraph(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end) {
+OptimalSubgraph&
+IteratedDijkstraPropagation::optimalSubgraph(IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end, QueryWorkspace& workspace, QueryCancellation& cancellation, QueryProgress& progress) {
 
 
     unsigned int numMonoids = multicostArray->num_monoids();
      
-    OptimalSubgraph optimalSubgraph(graph);
-    
-    iterate(optimalSubgraph, multicostArray, start, end, 0);
+    OptimalSubgraph& optimalSubgraph = workspace.getOptimalSubgraph(graph);
+
+    progress.numMonoidsOptimal = 0;
+    progress.numMonoidsSkipped = 0;
+    progress.isComplete = false;
+
+    // One pass on the whole multicost gives the same subgraph as iterating every monoid
+    if (multicostArray->is_lexicographic()) {
+        if (!iterate(optimalSubgraph, multicostArray, start, end, IMulticostGraph::ALL_MONOIDS, workspace, cancellation)) return optimalSubgraph;
+        if (optimalSubgraph.isGraphExists()) progress.numMonoidsOptimal = numMonoids;
+        progress.isComplete = true;
+        return optimalSubgraph;
+    }
 
-    if (!optimalSubgraph.isGraphExists()) return optimalSubgraph;
+    for (unsigned int i = 0; i < numMonoids; ++i) {
+        if (!iterate(optimalSubgraph, multicostArray, start, end, i, workspace, cancellation)) return optimalSubgraph;
+        if (!optimalSubgraph.isGraphExists()) break;
+        progress.numMonoidsOptimal = i + 1;
 
-    for (unsigned int i = 1; i < numMonoids; ++i) {
-        iterate(optimalSubgraph, multicostArray, start, end, i);
-        if (!optimalSubgraph.isGraphExists()) return optimalSubgraph;
+        if (optimalSubgraph.isSinglePath()) {
+            progress.numMonoidsOptimal = numMonoids;
+            progress.numMonoidsSkipped = numMonoids - (i + 1);
+            break;
+        }
     }
 
+    progress.isComplete = true;
+
     return optimalSubgraph;
 }
 
+
+
+int IteratedDijkstraPropagation::compareMonoid(IMulticostArray& multicostArray, const std::unique_ptr<MulticostID>& a, const std::unique_ptr<MulticostID>& b, unsigned int monoidIndex) {
+    if (monoidIndex == IMulticostGraph::ALL_MONOIDS) return multicostArray.compare(a, b);
+    return multicostArray.compare(a, b, monoidIndex);
+}
+
+
+
+std::unique_ptr<MulticostID> IteratedDijkstraPropagation::opMonoid(IMulticostArray& multicostArray, const std::unique_ptr<MulticostID>& a, const std::unique_ptr<MulticostID>& b, unsigned int monoidIndex) {
+    if (monoidIndex == IMulticostGraph::ALL_MONOIDS) return multicostArray.op(a, b);
+    return multicostArray.op(a, b, monoidIndex);
+}
+
+
+
+void IteratedDijkstraPropagation::opMonoid(IMulticostArray& multicostArray, const std::unique_ptr<MulticostID>& a, const std::unique_ptr<MulticostID>& b, const std::unique_ptr<MulticostID>& res, unsigned int monoidIndex) {
+    if (monoidIndex == IMulticostGraph::ALL_MONOIDS) {
+        multicostArray.op(a, b, res);
+    } else {
+        multicostArray.op(a, b, res, monoidIndex);
+    }
+}
+
+
+
+bool IteratedDijkstraPropagation::isIdentityMonoid(IMulticostArray& multicostArray, const std::unique_ptr<MulticostID>& a, unsigned int monoidIndex) {
+    if (monoidIndex == IMulticostGraph::ALL_MONOIDS) return multicostArray.is_identity(a);
+    return multicostArray.is_identity(a, monoidIndex);
+}
+
+
+SearchCost IteratedDijkstraPropagation::makeSearchCost(IMulticostArray& multicostArray, std::unique_ptr<MulticostID> weight, uint32_t frNodeId, uint32_t toNodeId, unsigned int monoidIndex, const std::unique_ptr<MulticostID>& lowerBound) {
+    SearchCost cost;
+
+    if (heuristic) {
+        if (monoidIndex == IMulticostGraph::ALL_MONOIDS) {
+            for (unsigned int k = 0; k < multicostArray.num_monoids(); ++k) heuristic->lowerBound(frNodeId, toNodeId, k, lowerBound);
+        } else {
+            heuristic->lowerBound(frNodeId, toNodeId, monoidIndex, lowerBound);
+        }
+        cost.priority = opMonoid(multicostArray, weight, lowerBound, monoidIndex);
+    }
+
+    cost.weight = std::move(weight);
+    return cost;
+}
+
+
+
+bool IteratedDijkstraPropagation::isTightEdge(IMulticostArray& multicostArray, const std::unique_ptr<MulticostID>& weight, const std::unique_ptr<MulticostID>& edgeCost, const std::unique_ptr<MulticostID>& nextWeight, unsigned int monoidIndex) {
+    std::unique_ptr<MulticostID> total = opMonoid(multicostArray, weight, edgeCost, monoidIndex);
+    return compareMonoid(multicostArray, total, nextWeight, monoidIndex) == 0;
+}
+
+
+
+QueryWorkspace& IteratedDijkstraPropagation::threadWorkspace() {
+    thread_local QueryWorkspace workspace;
+    return workspace;
+}
@@ -0,0 +1,83 @@
+#include "../../include/worker_pool.hpp"
+
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+WorkerPool::WorkerPool(unsigned int numThreads) {
+    for (unsigned int t = 1; t < numThreads; ++t) {
+        this->workers.emplace_back(&WorkerPool::runWorker, this);
+    }
+}
+
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->isStopping = true;
+    }
+    this->workerWakeup.notify_all();
+
+    for (std::thread& worker : this->workers) worker.join();
+}
+
+
+void WorkerPool::run(unsigned int numTasks, const std::function<void(unsigned int)>& task) {
+    if (numTasks == 0) return;
+
+    std::lock_guard<std::mutex> phaseLock(this->phaseMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->task = &task;
+        this->numTasks = numTasks;
+        this->nextTask = 0;
+        this->numTasksDone = 0;
+        this->phase += 1;
+    }
+    this->workerWakeup.notify_all();
+
+    runTasks();
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->phaseDone.wait(lock, [this]() { return this->numTasksDone == this->numTasks; });
+    this->task = nullptr;
+}
+
+
+void WorkerPool::runWorker() {
+    uint64_t lastPhase = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->workerWakeup.wait(lock, [this, lastPhase]() { return this->isStopping || this->phase != lastPhase; });
+            if (this->isStopping) return;
+            lastPhase = this->phase;
+        }
+
+        runTasks();
+    }
+}
+
+
+void WorkerPool::runTasks() {
+    while (true) {
+        const std::function<void(unsigned int)>* phaseTask;
+        unsigned int taskIndex;
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (this->nextTask >= this->numTasks) return;
+            phaseTask = this->task;
+            taskIndex = this->nextTask++;
+        }
+
+        (*phaseTask)(taskIndex);
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->numTasksDone += 1;
+        if (this->numTasksDone == this->numTasks) this->phaseDone.notify_all();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "../../include/cluster_grid_state.hpp"
+#include "../../include/grid_state.hpp"
+#include <cstdint>
+#include <vector>
+
+ClusterGridState::ClusterGridState() {
+    this->clusterSize = 1;
+}
+
+
+ClusterGridState::ClusterGridState(GridState cell, int clusterSize) {
+    this->cell = cell;
+    this->clusterSize = clusterSize;
+}
+
+
+std::vector<ClusterGridState> ClusterGridState::getNextStates() {
+    ClusterGridState buffer[MAX_NEXT_STATES];
+    unsigned int numNextStates = getNextStates(buffer);
+    return std::vector<ClusterGridState>(buffer, buffer + numNextStates);
+}
+
+
+unsigned int ClusterGridState::getNextStates(ClusterGridState* nextStates) {
+    unsigned int numNextStates = 0;
+
+    int clusterX = this->cell.x / this->clusterSize;
+    int clusterY = this->cell.y / this->clusterSize;
+
+    GridState nextCells[GridState::MAX_NEXT_STATES];
+    unsigned int numNextCells = this->cell.getNextStates(nextCells);
+
+    for (unsigned int i = 0; i < numNextCells; ++i) {
+        if (nextCells[i].x / this->clusterSize != clusterX || nextCells[i].y / this->clusterSize != clusterY) continue;
+        nextStates[numNextStates++] = ClusterGridState(nextCells[i], this->clusterSize);
+    }
+
+    return numNextStates;
+}
+
+
+uint32_t ClusterGridState::getUniqueId() {
+    return this->cell.getUniqueId();
+}
+
+
+uint32_t ClusterGridState::getClusterId() {
+    int numClustersX = (this->cell.getMap()->getWidth() + this->clusterSize - 1) / this->clusterSize;
+    return (this->cell.y / this->clusterSize) * numClustersX + this->cell.x / this->clusterSize;
+}
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "../../include/grid_map.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+
+// Spreads the low 16 bits of v over the even bits, enough for the local coordinates of a tile
+static uint32_t spreadBits(uint32_t v) {
+    v &= 0x0000FFFF;
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+// Inverse of spreadBits
+static uint32_t compactBits(uint32_t v) {
+    v &= 0x55555555;
+    v = (v | (v >> 1)) & 0x33333333;
+    v = (v | (v >> 2)) & 0x0F0F0F0F;
+    v = (v | (v >> 4)) & 0x00FF00FF;
+    v = (v | (v >> 8)) & 0x0000FFFF;
+    return v;
+}
+
+// Rotates the quadrant of side n so the curve of the next level starts at its corner
+static void rotateQuadrant(uint32_t n, uint32_t& x, uint32_t& y, uint32_t rx, uint32_t ry) {
+    if (ry != 0) return;
+    if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+    }
+    std::swap(x, y);
+}
+
+
+
+GridMap::GridMap(int width, int height, GridLayout layout) {
+    this->width = width;
+    this->height = height;
+    this->layout = layout;
+
+    // Curve tiles span the whole grid when it is small, so small grids keep a single curve
+    uint32_t curveSide = 1;
+    while (curveSide < static_cast<uint32_t>(std::max(width, height))) curveSide *= 2;
+    this->tileSide = std::min(curveSide, MAX_TILE_SIDE);
+    this->tileBits = 0;
+    while ((1u << this->tileBits) < this->tileSide) this->tileBits++;
+    this->numTilesX = (width + this->tileSide - 1) / this->tileSide;
+    uint64_t numTilesY = (height + this->tileSide - 1) / this->tileSide;
+
+    uint64_t numCells = layout == GridLayout::ROW_MAJOR ?
+        static_cast<uint64_t>(width) * height :
+        static_cast<uint64_t>(this->numTilesX) * numTilesY * this->tileSide * this->tileSide;
+
+    if (numCells > UINT32_MAX) {
+        std::cerr << "ERROR: grid of " << width << "x" << height << " has more cells than 32 bit ids can index" << std::endl;
+        exit(1);
+    }
+
+    this->cells = std::vector<bool>(numCells, true);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) this->cells[cellIndex(x, y)] = false;
+    }
+
+    this->obstacleCounts = std::vector<uint8_t>(numCells, 0);
+    this->terrainWeights = std::vector<float>(numCells, 1.0f);
+
+    this->numRegionsX = (width + REGION_SIDE - 1) / REGION_SIDE;
+    int numRegionsY = (height + REGION_SIDE - 1) / REGION_SIDE;
+    this->regionVersions = std::vector<uint32_t>(this->numRegionsX * numRegionsY, 0);
+}
+
+
+void GridMap::setTerrainWeight(int x, int y, float weight) {
+    this->terrainWeights[cellIndex(x, y)] = weight;
+    touchRegion(x, y);
+}
+
+
+void GridMap::setObstacle(int x, int y, bool isObstacle) {
+    uint32_t index = cellIndex(x, y);
+    if (this->cells[index] == isObstacle) return;
+
+    this->cells[index] = isObstacle;
+
+    // The obstacle counts of the neighbors change as well
+    touchRegion(x, y);
+    if (y > 0) touchRegion(x, y - 1);
+    if (y + 1 < this->height) touchRegion(x, y + 1);
+    if (x > 0) touchRegion(x - 1, y);
+    if (x + 1 < this->width) touchRegion(x + 1, y);
+
+    int delta = isObstacle ? 1 : -1;
+    if (y > 0) this->obstacleCounts[cellIndex(x, y - 1)] += delta;
+    if (y + 1 < this->height) this->obstacleCounts[cellIndex(x, y + 1)] += delta;
+    if (x > 0) this->obstacleCounts[cellIndex(x - 1, y)] += delta;
+    if (x + 1 < this->width) this->obstacleCounts[cellIndex(x + 1, y)] += delta;
+}
+
+
+void GridMap::setObstacles(const std::vector<bool>& obstacles) {
+    for (int y = 0; y < this->height; ++y) {
+        for (int x = 0; x < this->width; ++x) this->cells[cellIndex(x, y)] = obstacles[y * this->width + x];
+    }
+
+    for (uint32_t& version : this->regionVersions) version++;
+
+    countObstacles();
+}
+
+
+void GridMap::touchRegion(int x, int y) {
+    this->regionVersions[(y / REGION_SIDE) * this->numRegionsX + x / REGION_SIDE]++;
+}
+
+
+void GridMap::countObstacles() {
+    // Row major bytes with a free border, every cell then has four neighbors to add
+    int paddedWidth = this->width + 2;
+    std::vector<uint8_t> padded(paddedWidth * (this->height + 2), 0);
+
+    for (int y = 0; y < this->height; ++y) {
+        for (int x = 0; x < this->width; ++x) padded[(y + 1) * paddedWidth + x + 1] = this->cells[cellIndex(x, y)];
+    }
+
+    std::vector<uint8_t> rowCounts(this->width);
+
+    for (int y = 0; y < this->height; ++y) {
+        const uint8_t* top = &padded[y * paddedWidth + 1];
+        const uint8_t* row = &padded[(y + 1) * paddedWidth + 1];
+        const uint8_t* bot = &padded[(y + 2) * paddedWidth + 1];
+
+        // Branch free over the row, so the compiler vectorizes it
+        for (int x = 0; x < this->width; ++x) rowCounts[x] = top[x] + bot[x] + row[x - 1] + row[x + 1];
+
+        if (this->layout == GridLayout::ROW_MAJOR) {
+            std::copy(rowCounts.begin(), rowCounts.end(), this->obstacleCounts.begin() + y * this->width);
+        } else {
+            for (int x = 0; x < this->width; ++x) this->obstacleCounts[cellIndex(x, y)] = rowCounts[x];
+        }
+    }
+}
+
+
+uint32_t GridMap::cellIndex(int x, int y) const {
+    if (this->layout == GridLayout::ROW_MAJOR) return static_cast<uint32_t>(y) * this->width + x;
+
+    uint32_t tile = (y >> this->tileBits) * this->numTilesX + (x >> this->tileBits);
+    uint32_t tx = x & (this->tileSide - 1);
+    uint32_t ty = y & (this->tileSide - 1);
+    uint32_t local = 0;
+
+    switch (this->layout) {
+        case GridLayout::Z_ORDER:
+            local = spreadBits(tx) | (spreadBits(ty) << 1);
+            break;
+
+        case GridLayout::HILBERT: {
+            uint32_t n = this->tileSide;
+
+            for (uint32_t s = n / 2; s > 0; s /= 2) {
+                uint32_t rx = (tx & s) > 0;
+                uint32_t ry = (ty & s) > 0;
+                local += s * s * ((3 * rx) ^ ry);
+                rotateQuadrant(n, tx, ty, rx, ry);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return (tile << (2 * this->tileBits)) | local;
+}
+
+
+void GridMap::cellCoordinates(uint32_t index, int& x, int& y) const {
+    if (this->layout == GridLayout::ROW_MAJOR) {
+        x = index % this->width;
+        y = index / this->width;
+        return;
+    }
+
+    uint32_t tile = index >> (2 * this->tileBits);
+    uint32_t local = index & ((this->tileSide * this->tileSide) - 1);
+    uint32_t tx = 0;
+    uint32_t ty = 0;
+
+    switch (this->layout) {
+        case GridLayout::Z_ORDER:
+            tx = compactBits(local);
+            ty = compactBits(local >> 1);
+            break;
+
+        case GridLayout::HILBERT: {
+            uint32_t t = local;
+
+            for (uint32_t s = 1; s < this->tileSide; s *= 2) {
+                uint32_t rx = 1 & (t / 2);
+                uint32_t ry = 1 & (t ^ rx);
+                rotateQuadrant(s, tx, ty, rx, ry);
+                tx += s * rx;
+                ty += s * ry;
+                t /= 4;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    x = (tile % this->numTilesX) * this->tileSide + tx;
+    y = (tile / this->numTilesX) * this->tileSide + ty;
+}
+
+
+void GridMap::setLayout(GridLayout layout) {
+    GridMap map(this->width, this->height, layout);
+
+    std::vector<bool> obstacles(this->width * this->height);
+    for (int y = 0; y < this->height; ++y) {
+        for (int x = 0; x < this->width; ++x) {
+            obstacles[y * this->width + x] = isObstacle(x, y);
+            map.setTerrainWeight(x, y, this->terrainWeights[cellIndex(x, y)]);
+        }
+    }
+
+    // Versions keep growing, costs cached under the previous unique ids must not match again
+    map.regionVersions = std::move(this->regionVersions);
+    map.setObstacles(obstacles);
+    *this = std::move(map);
+}
+
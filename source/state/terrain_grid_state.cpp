@@ -0,0 +1,116 @@
+#include "../../include/terrain_grid_state.hpp"
+#include "../../include/grid_map.hpp"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Moves in order of connectivity, the first 4 orthogonal, then 4 diagonal, then 8 knight moves
+static const int MOVE_DX[16] = {0, 0, -1, 1, -1, 1, -1, 1, -1, 1, -2, 2, -2, 2, -1, 1};
+static const int MOVE_DY[16] = {-1, 1, 0, 0, -1, -1, 1, 1, -2, -2, -1, -1, 1, 1, 2, 2};
+
+
+TerrainGridState::TerrainGridState() {
+    this->x = 0;
+    this->y = 0;
+    this->map = nullptr;
+    this->linearPos = 0;
+    this->connectivity = GridConnectivity::EIGHT;
+}
+
+
+TerrainGridState::TerrainGridState(const GridMap& map, int x, int y, GridConnectivity connectivity) {
+    this->linearPos = map.cellIndex(x, y);
+    this->map = &map;
+    this->x = x;
+    this->y = y;
+    this->connectivity = connectivity;
+}
+
+
+std::vector<TerrainGridState> TerrainGridState::getNextStates() {
+    TerrainGridState buffer[MAX_NEXT_STATES];
+    unsigned int numNextStates = getNextStates(buffer);
+    return std::vector<TerrainGridState>(buffer, buffer + numNextStates);
+}
+
+
+unsigned int TerrainGridState::getNextStates(TerrainGridState* nextStates) {
+    unsigned int numNextStates = 0;
+
+    if (this->map->isObstacleAt(this->linearPos)) return numNextStates;
+
+    unsigned int numMoves = static_cast<unsigned int>(this->connectivity);
+
+    for (unsigned int i = 0; i < numMoves; ++i) {
+        int dx = MOVE_DX[i];
+        int dy = MOVE_DY[i];
+
+        if (!isFree(this->x + dx, this->y + dy)) continue;
+
+        // Cells crossed by the move, the destination aside
+        if (dx != 0 && dy != 0) {
+            int stepX = dx > 0 ? 1 : -1;
+            int stepY = dy > 0 ? 1 : -1;
+
+            if (std::abs(dx) == 2) {
+                if (!isFree(this->x + stepX, this->y) || !isFree(this->x + stepX, this->y + dy)) continue;
+            } else if (std::abs(dy) == 2) {
+                if (!isFree(this->x, this->y + stepY) || !isFree(this->x + dx, this->y + stepY)) continue;
+            } else {
+                if (!isFree(this->x + dx, this->y) || !isFree(this->x, this->y + dy)) continue;
+            }
+        }
+
+        nextStates[numNextStates++] = TerrainGridState(*this->map, this->x + dx, this->y + dy, this->connectivity);
+    }
+
+    return numNextStates;
+}
+
+
+uint32_t TerrainGridState::getUniqueId() {
+    return this->linearPos;
+}
+
+
+int TerrainGridState::numberOfNearbyObstacles() {
+    return this->map->getObstacleCount(this->linearPos);
+}
+
+
+int TerrainGridState::getMoveCost(const TerrainGridState& toState) const {
+    int cost;
+    getMoveCosts(&toState, 1, &cost);
+    return cost;
+}
+
+
+void TerrainGridState::getMoveCosts(const TerrainGridState* nextStates, unsigned int numNextStates, int* costs) const {
+    float squaredLengths[MAX_NEXT_STATES];
+    float weights[MAX_NEXT_STATES];
+
+    // Gathers the set first, so the arithmetic below runs over plain arrays
+    for (unsigned int i = 0; i < numNextStates; ++i) {
+        int dx = nextStates[i].x - this->x;
+        int dy = nextStates[i].y - this->y;
+        squaredLengths[i] = static_cast<float>(dx * dx + dy * dy);
+        weights[i] = this->map->getTerrainWeight(nextStates[i].linearPos);
+    }
+
+    float halfWeight = 0.5f * this->map->getTerrainWeight(this->linearPos);
+
+    for (unsigned int i = 0; i < numNextStates; ++i) {
+        costs[i] = static_cast<int>(std::sqrt(squaredLengths[i]) * (halfWeight + 0.5f * weights[i]) * COST_SCALE + 0.5f);
+    }
+}
+
+
+const GridMap* TerrainGridState::getMap() const {
+    return this->map;
+}
+
+
+bool TerrainGridState::isFree(int cellX, int cellY) const {
+    if (cellX < 0 || cellY < 0 || cellX >= this->map->getWidth() || cellY >= this->map->getHeight()) return false;
+    return !this->map->isObstacle(cellX, cellY);
+}
\ No newline at end of file
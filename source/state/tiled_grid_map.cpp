@@ -0,0 +1,269 @@
+#include "../../include/tiled_grid_map.hpp"
+#include "../../include/grid_map.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// File layout: magic, width, height, chunk side as uint32_t, then the chunks in row major
+// order of the chunk grid. A chunk is its cells in row major order, one bit each in uint64_t
+// words, cells of edge chunks outside the grid are obstacles.
+static constexpr unsigned int HEADER_SIZE = 4 * sizeof(uint32_t);
+
+
+TiledGridMap::TiledGridMap() {}
+
+
+TiledGridMap::~TiledGridMap() {
+    stopReader();
+}
+
+
+bool TiledGridMap::open(const std::string& path, unsigned int maxResidentChunks) {
+    stopReader();
+
+    this->file = std::ifstream(path, std::ios::binary);
+    if (!this->file) return false;
+
+    uint32_t header[4];
+    if (!this->file.read(reinterpret_cast<char*>(header), HEADER_SIZE) || header[0] != FILE_MAGIC || header[3] == 0) return false;
+
+    // TiledGridState ids are row major uint32_t
+    uint64_t numCells = static_cast<uint64_t>(header[1]) * header[2];
+    if (header[1] > INT32_MAX || header[2] > INT32_MAX || numCells > (static_cast<uint64_t>(1) << 32)) {
+        std::cerr << "ERROR: [TiledGridMap::open] " << path << " has " << header[1] << "x" << header[2] << " cells, more than 32 bit ids can index" << std::endl;
+        return false;
+    }
+
+    this->path = path;
+    this->width = header[1];
+    this->height = header[2];
+    this->chunkSide = header[3];
+    this->numChunksX = (this->width + this->chunkSide - 1) / this->chunkSide;
+    this->numChunksY = (this->height + this->chunkSide - 1) / this->chunkSide;
+    this->wordsPerChunk = (this->chunkSide * this->chunkSide + 63) / 64;
+    this->maxResidentChunks = std::max(maxResidentChunks, 1u);
+    this->maxReadyChunks = this->maxResidentChunks / 4;
+    this->maxSlots = this->maxResidentChunks - this->maxReadyChunks;
+
+    this->slots.clear();
+    this->chunkSlots.clear();
+    this->pendingChunks.clear();
+    this->lastChunkId = NO_CHUNK;
+    this->useCounter = 0;
+    this->stats = TiledGridStats();
+
+    this->requestedChunks.clear();
+    this->readyChunks.clear();
+    this->droppedChunks.clear();
+    this->isReading = false;
+    this->isStopping = false;
+    this->reader = std::thread(&TiledGridMap::runReader, this);
+
+    return true;
+}
+
+
+bool TiledGridMap::writeTiles(const std::string& path, const GridMap& map, int chunkSide) {
+    std::ofstream output(path, std::ios::binary);
+    if (!output || chunkSide <= 0) return false;
+
+    uint32_t header[4] = {FILE_MAGIC, static_cast<uint32_t>(map.getWidth()), static_cast<uint32_t>(map.getHeight()), static_cast<uint32_t>(chunkSide)};
+    output.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+
+    int numChunksX = (map.getWidth() + chunkSide - 1) / chunkSide;
+    int numChunksY = (map.getHeight() + chunkSide - 1) / chunkSide;
+    std::vector<uint64_t> words((chunkSide * chunkSide + 63) / 64);
+
+    for (int cy = 0; cy < numChunksY; ++cy) {
+        for (int cx = 0; cx < numChunksX; ++cx) {
+            std::fill(words.begin(), words.end(), 0);
+
+            for (int ly = 0; ly < chunkSide; ++ly) {
+                for (int lx = 0; lx < chunkSide; ++lx) {
+                    int x = cx * chunkSide + lx;
+                    int y = cy * chunkSide + ly;
+                    bool isObstacle = x >= map.getWidth() || y >= map.getHeight() || map.isObstacle(x, y);
+
+                    uint32_t bit = ly * chunkSide + lx;
+                    if (isObstacle) words[bit / 64] |= static_cast<uint64_t>(1) << (bit % 64);
+                }
+            }
+
+            output.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(uint64_t));
+        }
+    }
+
+    return static_cast<bool>(output);
+}
+
+
+void TiledGridMap::prefetch(int x, int y) {
+    if (this->maxReadyChunks == 0 || x < 0 || y < 0 || x >= this->width || y >= this->height) return;
+
+    uint32_t chunkId = (y / this->chunkSide) * this->numChunksX + x / this->chunkSide;
+    if (chunkId == this->lastChunkId || isResident(chunkId)) return;
+
+    {
+        std::lock_guard<std::mutex> lock(this->readerMutex);
+        clearDroppedChunks();
+
+        uint8_t& isPending = this->pendingChunks[chunkId];
+        if (isPending) return;
+        isPending = 1;
+
+        this->requestedChunks.push_back(chunkId);
+    }
+    this->readerWakeup.notify_one();
+}
+
+
+unsigned int TiledGridMap::getNumReadyChunks() {
+    std::lock_guard<std::mutex> lock(this->readerMutex);
+    return this->readyChunks.size();
+}
+
+
+void TiledGridMap::waitForPrefetches() {
+    std::unique_lock<std::mutex> lock(this->readerMutex);
+    this->readerIdle.wait(lock, [this]() { return this->isStopping || (this->requestedChunks.empty() && !this->isReading); });
+}
+
+
+void TiledGridMap::useChunk(uint32_t chunkId) {
+    if (!isResident(chunkId)) loadChunk(chunkId);
+
+    this->lastChunkId = chunkId;
+    this->lastSlot = this->chunkSlots.at(chunkId);
+    this->slots[this->lastSlot].lastUse = ++this->useCounter;
+}
+
+
+void TiledGridMap::loadChunk(uint32_t chunkId) {
+    std::vector<uint64_t> words;
+    bool isPrefetched = false;
+
+    uint8_t* isPending = this->pendingChunks.find(chunkId);
+    if (isPending != nullptr && *isPending) {
+        *isPending = 0;
+
+        std::lock_guard<std::mutex> lock(this->readerMutex);
+        clearDroppedChunks();
+
+        for (auto& ready : this->readyChunks) {
+            if (ready.first != chunkId) continue;
+            words = std::move(ready.second);
+            isPrefetched = true;
+        }
+
+        // Still queued, the planning thread reads it itself
+        this->requestedChunks.erase(std::remove(this->requestedChunks.begin(), this->requestedChunks.end(), chunkId), this->requestedChunks.end());
+
+        // Chunks that are no longer pending were read by this thread while the reader was busy with them
+        this->readyChunks.erase(std::remove_if(this->readyChunks.begin(), this->readyChunks.end(),
+            [this](const std::pair<uint32_t, std::vector<uint64_t>>& ready) {
+                const uint8_t* isReadyPending = this->pendingChunks.find(ready.first);
+                return isReadyPending == nullptr || !*isReadyPending;
+            }), this->readyChunks.end());
+    }
+
+    if (isPrefetched) {
+        this->stats.numPrefetchHits++;
+    } else {
+        // A failed read leaves the chunk blocked rather than free
+        if (!readChunk(this->file, chunkId, words)) words.assign(this->wordsPerChunk, ~static_cast<uint64_t>(0));
+        this->stats.numChunkLoads++;
+    }
+
+    uint32_t slot;
+    if (this->slots.size() < this->maxSlots) {
+        slot = this->slots.size();
+        this->slots.push_back({chunkId, 0, std::move(words)});
+    } else {
+        auto leastRecent = std::min_element(this->slots.begin(), this->slots.end(),
+            [](const ChunkSlot& a, const ChunkSlot& b) { return a.lastUse < b.lastUse; });
+        slot = leastRecent - this->slots.begin();
+
+        // FlatMap can not erase, the evicted chunk is marked with NO_CHUNK instead
+        this->chunkSlots[leastRecent->chunkId] = NO_CHUNK;
+        *leastRecent = {chunkId, 0, std::move(words)};
+        this->stats.numEvictions++;
+    }
+
+    this->chunkSlots[chunkId] = slot;
+}
+
+
+void TiledGridMap::clearDroppedChunks() {
+    for (uint32_t chunkId : this->droppedChunks) this->pendingChunks[chunkId] = 0;
+    this->droppedChunks.clear();
+}
+
+
+bool TiledGridMap::isResident(uint32_t chunkId) const {
+    const uint32_t* slot = this->chunkSlots.find(chunkId);
+    return slot != nullptr && *slot != NO_CHUNK;
+}
+
+
+bool TiledGridMap::readChunk(std::ifstream& chunkFile, uint32_t chunkId, std::vector<uint64_t>& words) const {
+    words.resize(this->wordsPerChunk);
+
+    uint64_t offset = HEADER_SIZE + static_cast<uint64_t>(chunkId) * this->wordsPerChunk * sizeof(uint64_t);
+    chunkFile.clear();
+    chunkFile.seekg(offset);
+    return static_cast<bool>(chunkFile.read(reinterpret_cast<char*>(words.data()), words.size() * sizeof(uint64_t)));
+}
+
+
+void TiledGridMap::runReader() {
+    std::ifstream readerFile(this->path, std::ios::binary);
+    std::vector<uint64_t> words;
+
+    std::unique_lock<std::mutex> lock(this->readerMutex);
+
+    while (true) {
+        this->readerWakeup.wait(lock, [this]() { return this->isStopping || this->requestedChunks.size() > 0; });
+        if (this->isStopping) return;
+
+        uint32_t chunkId = this->requestedChunks.front();
+        this->requestedChunks.pop_front();
+
+        // Prefetched chunks count against the memory budget, the oldest one makes room
+        if (!this->readyChunks.empty() && this->readyChunks.size() >= this->maxReadyChunks) {
+            this->droppedChunks.push_back(this->readyChunks.front().first);
+            this->readyChunks.erase(this->readyChunks.begin());
+        }
+
+        this->isReading = true;
+        lock.unlock();
+        bool isRead = readChunk(readerFile, chunkId, words);
+        lock.lock();
+        this->isReading = false;
+
+        if (isRead) {
+            this->readyChunks.push_back({chunkId, std::move(words)});
+        } else {
+            this->droppedChunks.push_back(chunkId);
+        }
+
+        if (this->requestedChunks.empty()) this->readerIdle.notify_all();
+    }
+}
+
+
+void TiledGridMap::stopReader() {
+    if (!this->reader.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(this->readerMutex);
+        this->isStopping = true;
+    }
+    this->readerWakeup.notify_one();
+    this->readerIdle.notify_all();
+    this->reader.join();
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "../../include/tiled_grid_state.hpp"
+#include "../../include/tiled_grid_map.hpp"
+#include <cstdint>
+#include <vector>
+
+TiledGridState::TiledGridState() {
+    this->x = 0;
+    this->y = 0;
+    this->map = nullptr;
+}
+
+
+TiledGridState::TiledGridState(TiledGridMap& map, int x, int y) {
+    this->map = &map;
+    this->x = x;
+    this->y = y;
+}
+
+
+std::vector<TiledGridState> TiledGridState::getNextStates() {
+    TiledGridState buffer[MAX_NEXT_STATES];
+    unsigned int numNextStates = getNextStates(buffer);
+    return std::vector<TiledGridState>(buffer, buffer + numNextStates);
+}
+
+
+unsigned int TiledGridState::getNextStates(TiledGridState* nextStates) {
+    unsigned int numNextStates = 0;
+
+    if (this->map->isObstacle(this->x, this->y)) return numNextStates;
+
+    prefetchAhead();
+
+    // Cells outside the grid are obstacles of the map
+    if (!this->map->isObstacle(this->x, this->y - 1)) nextStates[numNextStates++] = TiledGridState(*this->map, this->x, this->y - 1);
+    if (!this->map->isObstacle(this->x, this->y + 1)) nextStates[numNextStates++] = TiledGridState(*this->map, this->x, this->y + 1);
+    if (!this->map->isObstacle(this->x - 1, this->y)) nextStates[numNextStates++] = TiledGridState(*this->map, this->x - 1, this->y);
+    if (!this->map->isObstacle(this->x + 1, this->y)) nextStates[numNextStates++] = TiledGridState(*this->map, this->x + 1, this->y);
+
+    return numNextStates;
+}
+
+
+uint32_t TiledGridState::getUniqueId() {
+    return static_cast<uint32_t>(this->y) * this->map->getWidth() + this->x;
+}
+
+
+int TiledGridState::numberOfNearbyObstacles() {
+    int result = 0;
+
+    if (this->y > 0 && this->map->isObstacle(this->x, this->y - 1)) result++;
+    if (this->y + 1 < this->map->getHeight() && this->map->isObstacle(this->x, this->y + 1)) result++;
+    if (this->x > 0 && this->map->isObstacle(this->x - 1, this->y)) result++;
+    if (this->x + 1 < this->map->getWidth() && this->map->isObstacle(this->x + 1, this->y)) result++;
+
+    return result;
+}
+
+
+void TiledGridState::prefetchAhead() {
+    int chunkSide = this->map->getChunkSide();
+    int localX = this->x % chunkSide;
+    int localY = this->y % chunkSide;
+
+    if (localX < PREFETCH_MARGIN) this->map->prefetch(this->x - PREFETCH_MARGIN, this->y);
+    if (localX >= chunkSide - PREFETCH_MARGIN) this->map->prefetch(this->x + PREFETCH_MARGIN, this->y);
+    if (localY < PREFETCH_MARGIN) this->map->prefetch(this->x, this->y - PREFETCH_MARGIN);
+    if (localY >= chunkSide - PREFETCH_MARGIN) this->map->prefetch(this->x, this->y + PREFETCH_MARGIN);
+}
\ No newline at end of file
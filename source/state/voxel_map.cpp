@@ -0,0 +1,82 @@
+#include "../../include/voxel_map.hpp"
+#include <cstdint>
+#include <vector>
+
+static int localIndex(int x, int y, int z) {
+    constexpr int side = VoxelMap::BRICK_SIDE;
+    return ((z % side) * side + y % side) * side + x % side;
+}
+
+
+VoxelMap::VoxelMap(int width, int height, int depth) {
+    this->width = width;
+    this->height = height;
+    this->depth = depth;
+    this->numBricksX = (width + BRICK_SIDE - 1) / BRICK_SIDE;
+    this->numBricksY = (height + BRICK_SIDE - 1) / BRICK_SIDE;
+}
+
+
+bool VoxelMap::isObstacle(int x, int y, int z) const {
+    const Brick* brick = findBrick(x, y, z);
+    if (brick == nullptr) return false;
+
+    int bit = localIndex(x, y, z);
+    return (brick->occupancy[bit / 64] >> (bit % 64)) & 1;
+}
+
+
+int VoxelMap::getObstacleCount(int x, int y, int z) const {
+    const Brick* brick = findBrick(x, y, z);
+    return brick == nullptr ? 0 : brick->obstacleCounts[localIndex(x, y, z)];
+}
+
+
+void VoxelMap::setObstacle(int x, int y, int z, bool isObstacle) {
+    if (this->isObstacle(x, y, z) == isObstacle) return;
+
+    Brick& brick = getBrick(x, y, z);
+    int bit = localIndex(x, y, z);
+    brick.occupancy[bit / 64] ^= static_cast<uint64_t>(1) << (bit % 64);
+
+    static const int NEIGHBOR_DX[6] = {-1, 1, 0, 0, 0, 0};
+    static const int NEIGHBOR_DY[6] = {0, 0, -1, 1, 0, 0};
+    static const int NEIGHBOR_DZ[6] = {0, 0, 0, 0, -1, 1};
+
+    int delta = isObstacle ? 1 : -1;
+
+    for (int i = 0; i < 6; ++i) {
+        int nx = x + NEIGHBOR_DX[i];
+        int ny = y + NEIGHBOR_DY[i];
+        int nz = z + NEIGHBOR_DZ[i];
+        if (!isInside(nx, ny, nz)) continue;
+
+        // Neighbors across the brick border get their own brick for the count
+        getBrick(nx, ny, nz).obstacleCounts[localIndex(nx, ny, nz)] += delta;
+    }
+}
+
+
+uint32_t VoxelMap::brickId(int x, int y, int z) const {
+    return (static_cast<uint32_t>(z / BRICK_SIDE) * this->numBricksY + y / BRICK_SIDE) * this->numBricksX + x / BRICK_SIDE;
+}
+
+
+const VoxelMap::Brick* VoxelMap::findBrick(int x, int y, int z) const {
+    const uint32_t* index = this->brickIndices.find(brickId(x, y, z));
+    return index == nullptr ? nullptr : &this->bricks[*index];
+}
+
+
+VoxelMap::Brick& VoxelMap::getBrick(int x, int y, int z) {
+    uint32_t id = brickId(x, y, z);
+
+    const uint32_t* index = this->brickIndices.find(id);
+    if (index != nullptr) return this->bricks[*index];
+
+    this->brickIndices[id] = this->bricks.size();
+    this->bricks.emplace_back();
+    this->bricks.back().occupancy.fill(0);
+    this->bricks.back().obstacleCounts.fill(0);
+    return this->bricks.back();
+}
\ No newline at end of file
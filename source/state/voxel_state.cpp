@@ -0,0 +1,93 @@
+#include "../../include/voxel_state.hpp"
+#include "../../include/voxel_map.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// Rounded lengths of the moves along 1, 2 and 3 axes: 1, sqrt(2), sqrt(3)
+static const int MOVE_LENGTHS[4] = {0, VoxelState::COST_SCALE, 1414, 1732};
+
+
+VoxelState::VoxelState() {
+    this->x = 0;
+    this->y = 0;
+    this->z = 0;
+    this->map = nullptr;
+    this->connectivity = VoxelConnectivity::TWENTY_SIX;
+}
+
+
+VoxelState::VoxelState(const VoxelMap& map, int x, int y, int z, VoxelConnectivity connectivity) {
+    this->map = &map;
+    this->x = x;
+    this->y = y;
+    this->z = z;
+    this->connectivity = connectivity;
+}
+
+
+std::vector<VoxelState> VoxelState::getNextStates() {
+    VoxelState buffer[MAX_NEXT_STATES];
+    unsigned int numNextStates = getNextStates(buffer);
+    return std::vector<VoxelState>(buffer, buffer + numNextStates);
+}
+
+
+unsigned int VoxelState::getNextStates(VoxelState* nextStates) {
+    unsigned int numNextStates = 0;
+
+    if (!isFree(this->x, this->y, this->z)) return numNextStates;
+
+    bool isSixConnected = this->connectivity == VoxelConnectivity::SIX;
+
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int numAxes = (dx != 0) + (dy != 0) + (dz != 0);
+                if (numAxes == 0 || (isSixConnected && numAxes > 1)) continue;
+
+                // The box of the move, its corner at the current voxel aside
+                bool isBlocked = false;
+                for (int bz = 0; bz <= std::abs(dz) && !isBlocked; ++bz) {
+                    for (int by = 0; by <= std::abs(dy) && !isBlocked; ++by) {
+                        for (int bx = 0; bx <= std::abs(dx) && !isBlocked; ++bx) {
+                            if (bx + by + bz == 0) continue;
+                            isBlocked = !isFree(this->x + bx * dx, this->y + by * dy, this->z + bz * dz);
+                        }
+                    }
+                }
+                if (isBlocked) continue;
+
+                nextStates[numNextStates++] = VoxelState(*this->map, this->x + dx, this->y + dy, this->z + dz, this->connectivity);
+            }
+        }
+    }
+
+    return numNextStates;
+}
+
+
+uint32_t VoxelState::getUniqueId() {
+    return this->map->voxelIndex(this->x, this->y, this->z);
+}
+
+
+int VoxelState::numberOfNearbyObstacles() {
+    return this->map->getObstacleCount(this->x, this->y, this->z);
+}
+
+
+int VoxelState::getMoveCost(const VoxelState& toState) const {
+    int numAxes = (toState.x != this->x) + (toState.y != this->y) + (toState.z != this->z);
+    return MOVE_LENGTHS[numAxes];
+}
+
+
+const VoxelMap* VoxelState::getMap() const {
+    return this->map;
+}
+
+
+bool VoxelState::isFree(int voxelX, int voxelY, int voxelZ) const {
+    return this->map->isInside(voxelX, voxelY, voxelZ) && !this->map->isObstacle(voxelX, voxelY, voxelZ);
+}
\ No newline at end of file
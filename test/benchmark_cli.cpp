@@ -0,0 +1,215 @@
+#include "counting_allocator.hpp"
+
+#include "../include/contraction_hierarchy_propagation.hpp"
+#include "../include/example_setup.hpp"
+#include "../include/grid_map.hpp"
+#include "../include/iterated_dijkstra_propagation.hpp"
+#include "../include/moving_ai_benchmark.hpp"
+#include "../include/single_optimal_path_finder.hpp"
+#include "../include/terrain_grid_state.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+// Heap of the process through the counting operator new of this executable
+class CountingHeapMeter : public IHeapMeter {
+public:
+    int64_t getBytesInUse() override {
+        return allocationCounters().bytesInUse;
+    };
+
+    int64_t getPeakBytes() override {
+        return allocationCounters().peakBytes;
+    };
+
+    void resetPeak() override {
+        resetPeakBytes();
+    };
+
+    uint64_t getNumAllocations() override {
+        return allocationCounters().numAllocations;
+    };
+};
+
+
+static const char* layoutName(GridLayout layout) {
+    switch (layout) {
+        case GridLayout::Z_ORDER: return "z_order";
+        case GridLayout::HILBERT: return "hilbert";
+        default: return "row_major";
+    }
+}
+
+
+static void printUsage() {
+    std::cerr << "usage: multicost_benchmark <map file> <scen file> [--queries] [--ch] [--layouts <queries>] [--engine <queries>]" << std::endl;
+    std::cerr << "  --queries           print every query as csv" << std::endl;
+    std::cerr << "  --ch                preprocess a contraction hierarchy of the map, report its stats and time its queries against IDP, slow on large maps" << std::endl;
+    std::cerr << "  --layouts <queries> time random queries on every cell layout, with cache and dTLB misses on Linux" << std::endl;
+    std::cerr << "  --engine <queries>  compare IteratedDijkstraPropagation with IdpEngine on random queries" << std::endl;
+}
+
+
+// Contraction hierarchy of the 8 connected cells reachable from the scenario starts, with the costs of the scenarios
+// Then times the scenario queries through the hierarchy and through IDP on the same explored graph
+static void reportContractionHierarchy(const GridMap& map, const std::vector<MovingAiScenario>& scenarios) {
+    std::array<std::function<int(int a, int b)>, 2> compares = {
+        [](int a, int b) { return a - b; },
+        [](int a, int b) { return a - b; }
+    };
+    std::array<std::function<int(int a, int b)>, 2> ops = {
+        [](int a, int b) { return a + b; },
+        [](int a, int b) { return a + b; }
+    };
+    std::array<std::function<int(TerrainGridState& a, TerrainGridState& b)>, 2> computes = {
+        [](TerrainGridState& a, TerrainGridState& b) { return a.getMoveCost(b); },
+        [](TerrainGridState& a, TerrainGridState& b) { return a.numberOfNearbyObstacles() + b.numberOfNearbyObstacles(); }
+    };
+
+    SingleOptimalPathFinder<TerrainGridState> pathFinder(std::array<int, 2>{0, 0}, compares, ops, computes, true);
+
+    // Queries outside the hierarchy would fall back to IDP, so every start seeds it
+    std::vector<TerrainGridState> seeds;
+    for (const MovingAiScenario& scenario : scenarios) seeds.push_back(TerrainGridState(map, scenario.startX, scenario.startY));
+
+    ContractionHierarchyPropagation hierarchy;
+    pathFinder.preprocess(hierarchy, seeds);
+
+    const ContractionHierarchyStats& stats = hierarchy.getStats();
+    std::cout << "ch nodes " << stats.numNodes << " edges " << stats.numEdges << " shortcuts " << stats.numShortcuts
+        << " explore " << stats.exploreMilliseconds << " ms contract " << stats.contractMilliseconds << " ms" << std::endl;
+
+    IteratedDijkstraPropagation iterated;
+    double hierarchyTotal = 0;
+    double hierarchyMax = 0;
+    double iteratedTotal = 0;
+    double iteratedMax = 0;
+
+    for (const MovingAiScenario& scenario : scenarios) {
+        TerrainGridState start(map, scenario.startX, scenario.startY);
+        TerrainGridState goal(map, scenario.goalX, scenario.goalY);
+
+        auto begin = std::chrono::steady_clock::now();
+        pathFinder.getOptimalPath(hierarchy, start, goal);
+        double hierarchyMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+        begin = std::chrono::steady_clock::now();
+        pathFinder.getOptimalPath(iterated, start, goal);
+        double iteratedMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+        hierarchyTotal += hierarchyMicroseconds;
+        hierarchyMax = std::max(hierarchyMax, hierarchyMicroseconds);
+        iteratedTotal += iteratedMicroseconds;
+        iteratedMax = std::max(iteratedMax, iteratedMicroseconds);
+    }
+
+    std::cout << "ch queries " << scenarios.size() << " mean_us " << hierarchyTotal / scenarios.size() << " max_us " << hierarchyMax
+        << " idp mean_us " << iteratedTotal / scenarios.size() << " max_us " << iteratedMax << std::endl;
+}
+
+
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+
+    std::string mapPath = argv[1];
+    std::string scenarioPath = argv[2];
+    bool isPrintingQueries = false;
+    bool isRunningHierarchy = false;
+    unsigned int numLayoutQueries = 0;
+    unsigned int numEngineQueries = 0;
+
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--queries") == 0) {
+            isPrintingQueries = true;
+        } else if (std::strcmp(argv[i], "--ch") == 0) {
+            isRunningHierarchy = true;
+        } else if (std::strcmp(argv[i], "--layouts") == 0 && i + 1 < argc) {
+            numLayoutQueries = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            numEngineQueries = std::atoi(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+
+    auto loadBegin = std::chrono::steady_clock::now();
+    std::shared_ptr<GridMap> map;
+    if (!loadMovingAiMap(mapPath, map)) {
+        std::cerr << "ERROR: can not load map " << mapPath << std::endl;
+        return 1;
+    }
+    double loadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadBegin).count();
+
+    std::vector<MovingAiScenario> scenarios;
+    if (!loadMovingAiScenarios(scenarioPath, *map, scenarios)) {
+        std::cerr << "ERROR: can not load scenarios " << scenarioPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "map " << map->getWidth() << "x" << map->getHeight() << " loaded in " << loadMilliseconds << " ms, "
+        << scenarios.size() << " scenarios" << std::endl;
+
+    std::vector<MovingAiQueryResult> queries;
+    CountingHeapMeter heapMeter;
+    std::vector<MovingAiBucketResult> buckets = runMovingAiScenarios(map, scenarios, queries, &heapMeter);
+
+    if (isPrintingQueries) {
+        std::cout << "bucket,solved,length,optimal_length,ms,expansions,nodes,heap_bytes,allocations" << std::endl;
+        for (const MovingAiQueryResult& query : queries) {
+            std::cout << query.bucket << "," << query.isSolved << "," << query.length << "," << query.optimalLength << ","
+                << query.milliseconds << "," << query.numExpansions << "," << query.numNodes << ","
+                << query.peakHeapBytes << "," << query.numAllocations << std::endl;
+        }
+    }
+
+    std::cout << "bucket queries mean_ms max_ms mean_expansions unsolved suboptimal max_heap_kib" << std::endl;
+    for (const MovingAiBucketResult& bucket : buckets) {
+        if (bucket.numQueries == 0) continue;
+        std::cout << bucket.bucket << " " << bucket.numQueries << " " << bucket.totalMilliseconds / bucket.numQueries << " "
+            << bucket.maxMilliseconds << " " << static_cast<double>(bucket.numExpansions) / bucket.numQueries << " "
+            << bucket.numUnsolved << " " << bucket.numSuboptimal << " " << bucket.maxPeakHeapBytes / 1024.0 << std::endl;
+    }
+
+    if (isRunningHierarchy && scenarios.size() > 0) {
+        reportContractionHierarchy(*map, scenarios);
+    }
+
+    if (numLayoutQueries > 0) {
+        // 4 connected cells with the costs of ExampleSetup
+        ExampleSetup setup(map);
+        for (const LayoutBenchmark& benchmark : setup.benchmarkLayouts(numLayoutQueries, 1)) {
+            std::cout << "layout " << layoutName(benchmark.layout) << " explore " << benchmark.exploreMilliseconds
+                << " ms queries " << benchmark.queryMilliseconds << " ms";
+            if (benchmark.hasCounters) {
+                std::cout << " cache_misses " << benchmark.cacheMisses << " dtlb_misses " << benchmark.dtlbMisses;
+            } else {
+                std::cout << " (no hardware counters, time only)";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    if (numEngineQueries > 0) {
+        // 4 connected cells with the costs of ExampleSetup
+        ExampleSetup setup(map);
+        EngineBenchmark benchmark = setup.benchmarkEngine(numEngineQueries, 1);
+        std::cout << "engine queries " << benchmark.numQueries << " mismatches " << benchmark.numMismatches
+            << " idp " << benchmark.idpMilliseconds << " ms engine " << benchmark.engineMilliseconds << " ms" << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+// Batched IMulticostCompute::computeCosts against per edge computeCost
+// For the default batches of the interface, the batches of MonoMulticostCompute built from per edge
+// functions and those built from batch functions, both overloads must give every edge the costs
+// computeCost gives it. The indexed overload must fill null destinations and only overwrite the
+// monoid at index of existing ones
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../include/multicost_array.hpp"
+#include "../include/multicost_compute.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MONOIDS = 3;
+constexpr unsigned int NUM_BATCHES = 50;
+constexpr unsigned int MAX_BATCH_SIZE = 20;
+
+
+struct TestState {
+    int x;
+    int y;
+};
+
+using Array = MonoMulticostArray<int, NUM_MONOIDS>;
+using Compute = MonoMulticostCompute<TestState, int, NUM_MONOIDS>;
+
+
+const std::array<std::function<int(TestState& a, TestState& b)>, NUM_MONOIDS> COMPUTES = {
+    [](TestState& a, TestState& b) { return std::abs(a.x - b.x) + std::abs(a.y - b.y); },
+    [](TestState& a, TestState& b) { return a.x * b.y - a.y * b.x; },
+    [](TestState&, TestState& b) { return (b.x * 7 + b.y * 13) % 11; }
+};
+
+
+// The same functions written over whole batches
+std::array<Compute::BatchCompute, NUM_MONOIDS> batchComputes() {
+    std::array<Compute::BatchCompute, NUM_MONOIDS> batches;
+    for (unsigned int k = 0; k < NUM_MONOIDS; ++k) {
+        batches[k] = [k](TestState& a, TestState* bs, unsigned int numStates, int* costs) {
+            for (unsigned int i = 0; i < numStates; ++i) costs[i] = COMPUTES[k](a, bs[i]);
+        };
+    }
+    return batches;
+}
+
+
+// Keeps the default batches of IMulticostCompute
+class EdgeCompute : public IMulticostCompute<TestState> {
+public:
+    EdgeCompute(std::shared_ptr<Array> multicostArray) : compute(multicostArray, COMPUTES) {};
+
+    std::unique_ptr<MulticostID> computeCost(TestState& a, TestState& b) override {
+        return compute.computeCost(a, b);
+    };
+
+    std::unique_ptr<MulticostID> computeCost(TestState& a, TestState& b, unsigned int index) override {
+        return compute.computeCost(a, b, index);
+    };
+
+    void computeCost(TestState& a, TestState& b, const std::unique_ptr<MulticostID>& dest, unsigned int index) override {
+        compute.computeCost(a, b, dest, index);
+    };
+
+private:
+    Compute compute;
+};
+
+
+void checkBatches(IMulticostCompute<TestState>& compute, Array& multicostArray, std::mt19937& random) {
+    for (unsigned int batch = 0; batch < NUM_BATCHES; ++batch) {
+        // Sizes go up and down, so the scratch buffers are reused at every size
+        unsigned int numStates = random() % (MAX_BATCH_SIZE + 1);
+
+        TestState a = {static_cast<int>(random() % 50), static_cast<int>(random() % 50)};
+        std::vector<TestState> bs(numStates);
+        for (TestState& b : bs) b = {static_cast<int>(random() % 50), static_cast<int>(random() % 50)};
+
+        std::vector<std::unique_ptr<MulticostID>> dests(numStates);
+        compute.computeCosts(a, bs.data(), numStates, dests.data());
+
+        for (unsigned int i = 0; i < numStates; ++i) {
+            CHECK(dests[i] != nullptr);
+            if (!dests[i]) continue;
+            CHECK(multicostArray.get_values(dests[i]) == multicostArray.get_values(compute.computeCost(a, bs[i])));
+        }
+
+        for (unsigned int index = 0; index < NUM_MONOIDS; ++index) {
+            // Half the destinations exist with costs to keep on the other monoids
+            std::vector<std::unique_ptr<MulticostID>> indexDests(numStates);
+            std::vector<std::array<int, NUM_MONOIDS>> previous(numStates);
+
+            for (unsigned int i = 0; i < numStates; ++i) {
+                if (random() % 2 == 0) continue;
+                previous[i] = {-1, -2, -3};
+                std::array<int, NUM_MONOIDS> values = previous[i];
+                indexDests[i] = multicostArray.make_multicost(std::move(values));
+            }
+
+            std::vector<bool> isExisting(numStates);
+            for (unsigned int i = 0; i < numStates; ++i) isExisting[i] = indexDests[i] != nullptr;
+
+            compute.computeCosts(a, bs.data(), numStates, indexDests.data(), index);
+
+            for (unsigned int i = 0; i < numStates; ++i) {
+                CHECK(indexDests[i] != nullptr);
+                if (!indexDests[i]) continue;
+
+                const std::array<int, NUM_MONOIDS>& values = multicostArray.get_values(indexDests[i]);
+                CHECK(values[index] == multicostArray.get_values(compute.computeCost(a, bs[i], index))[index]);
+
+                if (!isExisting[i]) continue;
+                for (unsigned int k = 0; k < NUM_MONOIDS; ++k) {
+                    if (k != index) CHECK(values[k] == previous[i][k]);
+                }
+            }
+        }
+    }
+}
+
+
+int main() {
+    std::mt19937 random(48);
+
+    MonoMulticostProps<int, NUM_MONOIDS> props = additiveProps<NUM_MONOIDS>(false);
+    auto multicostArray = std::make_shared<Array>(props);
+
+    EdgeCompute edgeCompute(multicostArray);
+    checkBatches(edgeCompute, *multicostArray, random);
+
+    Compute perEdgeCompute(multicostArray, COMPUTES);
+    checkBatches(perEdgeCompute, *multicostArray, random);
+
+    Compute batchCompute(multicostArray, batchComputes());
+    checkBatches(batchCompute, *multicostArray, random);
+
+    return testResult();
+}
\ No newline at end of file
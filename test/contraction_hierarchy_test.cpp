@@ -0,0 +1,51 @@
+// Equivalence test of ContractionHierarchyPropagation and IteratedDijkstraPropagation
+// On random graphs and grids full of ties both must find the same optimal subgraph
+// and paths of the same weights. The first monoid has positive costs, since the
+// hierarchy leaves out the edges that are only tight through zero cost cycles
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../include/contraction_hierarchy_propagation.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MONOIDS = 2;
+constexpr unsigned int NUM_GRAPHS = 40;
+constexpr unsigned int NUM_QUERIES = 25;
+
+
+unsigned int compareQueries(const TestGraph<NUM_MONOIDS>& testGraph, std::mt19937& random) {
+    auto multicostArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(false));
+
+    StaticMulticostGraph graph;
+    addEdges<NUM_MONOIDS>(graph, *multicostArray, testGraph.edges);
+
+    std::vector<uint32_t> seeds;
+    for (uint32_t node = 0; node < testGraph.numNodes; ++node) seeds.push_back(node);
+
+    ContractionHierarchyPropagation hierarchy;
+    hierarchy.preprocess(graph, multicostArray, seeds);
+
+    return compareRandomQueries(hierarchy, graph, multicostArray, testGraph.numNodes, NUM_QUERIES, random);
+}
+
+
+int main() {
+    std::mt19937 random(30);
+
+    unsigned int numReachable = 0;
+
+    for (TestGraph<NUM_MONOIDS>& testGraph : randomGraphs<NUM_MONOIDS>(NUM_GRAPHS, 64, 3, random)) {
+        for (TestEdge<NUM_MONOIDS>& edge : testGraph.edges) edge.cost[0] += 1;
+        numReachable += compareQueries(testGraph, random);
+    }
+
+    for (const TestGraph<NUM_MONOIDS>& testGraph : gridGraphs<NUM_MONOIDS>(NUM_GRAPHS / 4, 13, 1, random)) {
+        numReachable += compareQueries(testGraph, random);
+    }
+
+    checkNumReachable(numReachable, NUM_GRAPHS);
+    return testResult();
+}
\ No newline at end of file
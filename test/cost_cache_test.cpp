@@ -0,0 +1,165 @@
+// CachedMulticostCompute against uncached planning on a GridMap with region versions
+// Replanning from a cleared graph must hit the cache for every edge, and after an obstacle is
+// set only the edges around the touched regions may be computed again. Cached and uncached
+// planning must find paths of the same multicosts, and batches must match single edge costs
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+#include "../include/cached_multicost_compute.hpp"
+#include "../include/grid_map.hpp"
+#include "../include/grid_state.hpp"
+#include "../include/iterated_dijkstra_propagation.hpp"
+#include "../include/single_optimal_path_finder.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MONOIDS = 2;
+constexpr int SIDE = 96;
+
+using Costs = std::array<int, NUM_MONOIDS>;
+
+const std::array<std::function<int(int a, int b)>, NUM_MONOIDS> COMPARES = {
+    [](int a, int b) { return a - b; },
+    [](int a, int b) { return a - b; }
+};
+const std::array<std::function<int(int a, int b)>, NUM_MONOIDS> OPS = {
+    [](int a, int b) { return a + b; },
+    [](int a, int b) { return a + b; }
+};
+
+
+// Edges whose costs were computed, as the regions of their two cells
+std::vector<std::pair<uint32_t, uint32_t>> computedEdges;
+
+uint32_t regionOf(int x, int y) {
+    return (y / GridMap::REGION_SIDE) * ((SIDE + GridMap::REGION_SIDE - 1) / GridMap::REGION_SIDE) + x / GridMap::REGION_SIDE;
+}
+
+const std::array<std::function<int(GridState& a, GridState& b)>, NUM_MONOIDS> COMPUTES = {
+    [](GridState&, GridState&) { return 1; },
+    [](GridState& a, GridState& b) { return a.numberOfNearbyObstacles() + b.numberOfNearbyObstacles(); }
+};
+
+// The computes behind the cache also record their edges
+const std::array<std::function<int(GridState& a, GridState& b)>, NUM_MONOIDS> RECORDED_COMPUTES = {
+    [](GridState& a, GridState& b) {
+        computedEdges.push_back({regionOf(a.x, a.y), regionOf(b.x, b.y)});
+        return COMPUTES[0](a, b);
+    },
+    [](GridState& a, GridState& b) {
+        computedEdges.push_back({regionOf(a.x, a.y), regionOf(b.x, b.y)});
+        return COMPUTES[1](a, b);
+    }
+};
+
+
+Costs pathCosts(std::vector<GridState>& path) {
+    Costs costs = {0, 0};
+    for (unsigned int i = 0; i + 1 < path.size(); ++i) {
+        costs[0] += 1;
+        costs[1] += path[i].numberOfNearbyObstacles() + path[i + 1].numberOfNearbyObstacles();
+    }
+    return costs;
+}
+
+
+// Multicosts of the path of a fresh uncached planner
+Costs uncachedCosts(const GridMap& map, GridState start, GridState end) {
+    SingleOptimalPathFinder<GridState> pathFinder(Costs{0, 0}, COMPARES, OPS, COMPUTES);
+    IteratedDijkstraPropagation pathfind;
+
+    std::vector<GridState> path = pathFinder.getOptimalPath(pathfind, start, end);
+    CHECK(path.size() > 0);
+    return pathCosts(path);
+}
+
+
+void checkBatches(std::shared_ptr<MonoMulticostArray<int, NUM_MONOIDS>> multicostArray, CachedMulticostCompute<GridState, int, NUM_MONOIDS>& compute, const GridMap& map) {
+    GridState a(map, 40, 40);
+    GridState bs[GridState::MAX_NEXT_STATES];
+    unsigned int numStates = a.getNextStates(bs);
+
+    std::vector<std::unique_ptr<MulticostID>> allMonoids(numStates);
+    compute.computeCosts(a, bs, numStates, allMonoids.data());
+
+    // The second monoid into existing multicosts, the first into new ones
+    std::vector<std::unique_ptr<MulticostID>> byMonoid(numStates);
+    compute.computeCosts(a, bs, numStates, byMonoid.data(), 0);
+    compute.computeCosts(a, bs, numStates, byMonoid.data(), 1);
+
+    for (unsigned int i = 0; i < numStates; ++i) {
+        Costs expected = {COMPUTES[0](a, bs[i]), COMPUTES[1](a, bs[i])};
+        CHECK(multicostArray->get_values(allMonoids[i]) == expected);
+        CHECK(multicostArray->get_values(byMonoid[i]) == expected);
+    }
+}
+
+
+int main() {
+    std::mt19937 random(49);
+
+    GridMap map(SIDE, SIDE);
+    for (int i = 0; i < SIDE * SIDE / 8; ++i) map.setObstacle(random() % SIDE, random() % SIDE, true);
+    map.setObstacle(0, 0, false);
+    map.setObstacle(SIDE - 1, SIDE - 1, false);
+
+    auto multicostArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(MonoMulticostProps<int, NUM_MONOIDS>({0, 0}, COMPARES, OPS));
+    auto cache = std::make_shared<CostCache<int>>(1 << 20);
+
+    // Costs read the obstacles around both cells, whose counts live in the regions of the cells
+    std::function<uint32_t(GridState& a, GridState& b)> edgeVersion = [&map](GridState& a, GridState& b) {
+        return map.getRegionVersion(a.x, a.y) + map.getRegionVersion(b.x, b.y);
+    };
+    auto compute = std::make_shared<CachedMulticostCompute<GridState, int, NUM_MONOIDS>>(multicostArray, RECORDED_COMPUTES, edgeVersion, cache);
+
+    SingleOptimalPathFinder<GridState> pathFinder(multicostArray, compute);
+    IteratedDijkstraPropagation pathfind;
+
+    GridState start(map, 0, 0);
+    GridState end(map, SIDE - 1, SIDE - 1);
+
+    std::vector<GridState> path = pathFinder.getOptimalPath(pathfind, start, end);
+    CHECK(computedEdges.size() > 0);
+    CHECK(path.size() > 0 && pathCosts(path) == uncachedCosts(map, start, end));
+
+    // Same map, every edge is served by the cache
+    computedEdges.clear();
+    pathFinder.clearGraph();
+    path = pathFinder.getOptimalPath(pathfind, start, end);
+    CHECK(computedEdges.empty());
+    CHECK(cache->getStats().numHits > 0);
+
+    // An obstacle on the path touches its region and the regions of its neighbors
+    GridState blocked = path[path.size() / 2];
+    std::set<uint32_t> touchedRegions;
+    touchedRegions.insert(regionOf(blocked.x, blocked.y));
+    if (blocked.x > 0) touchedRegions.insert(regionOf(blocked.x - 1, blocked.y));
+    if (blocked.x + 1 < SIDE) touchedRegions.insert(regionOf(blocked.x + 1, blocked.y));
+    if (blocked.y > 0) touchedRegions.insert(regionOf(blocked.x, blocked.y - 1));
+    if (blocked.y + 1 < SIDE) touchedRegions.insert(regionOf(blocked.x, blocked.y + 1));
+
+    map.setObstacle(blocked.x, blocked.y, true);
+
+    computedEdges.clear();
+    pathFinder.clearGraph();
+    path = pathFinder.getOptimalPath(pathfind, start, end);
+
+    CHECK(computedEdges.size() > 0);
+    for (auto& [frRegion, toRegion] : computedEdges) {
+        CHECK(touchedRegions.count(frRegion) > 0 || touchedRegions.count(toRegion) > 0);
+    }
+    CHECK(path.size() > 0 && pathCosts(path) == uncachedCosts(map, start, end));
+    for (GridState& cell : path) CHECK(!map.isObstacle(cell.x, cell.y));
+
+    std::cout << computedEdges.size() << " costs computed again after the edit" << std::endl;
+
+    checkBatches(multicostArray, *compute, map);
+
+    return testResult();
+}
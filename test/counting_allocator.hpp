@@ -0,0 +1,88 @@
+#ifndef COUNTING_ALLOCATOR_H
+#define COUNTING_ALLOCATOR_H
+
+// Replaces the global operator new and delete of the executable with versions that count
+// allocations and the bytes in use, include it from a single source file of the executable
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+
+struct AllocationCounters {
+    std::atomic<uint64_t> numAllocations{0};
+    std::atomic<uint64_t> numFrees{0};
+    std::atomic<int64_t> bytesInUse{0};
+    std::atomic<int64_t> peakBytes{0};
+};
+
+inline AllocationCounters& allocationCounters() {
+    static AllocationCounters counters;
+    return counters;
+}
+
+// Starts a new peak from the bytes in use
+inline void resetPeakBytes() {
+    AllocationCounters& counters = allocationCounters();
+    counters.peakBytes = counters.bytesInUse.load();
+}
+
+// The requested size is kept in a header in front of every block
+constexpr std::size_t ALLOCATION_HEADER_SIZE = alignof(std::max_align_t);
+
+inline void* countedAllocate(std::size_t size) {
+    void* block = std::malloc(size + ALLOCATION_HEADER_SIZE);
+    if (block == nullptr) throw std::bad_alloc();
+
+    *static_cast<std::size_t*>(block) = size;
+
+    AllocationCounters& counters = allocationCounters();
+    counters.numAllocations++;
+    int64_t bytesInUse = counters.bytesInUse += size;
+
+    int64_t peakBytes = counters.peakBytes;
+    while (bytesInUse > peakBytes && !counters.peakBytes.compare_exchange_weak(peakBytes, bytesInUse)) {}
+
+    return static_cast<char*>(block) + ALLOCATION_HEADER_SIZE;
+}
+
+inline void countedFree(void* pointer) {
+    if (pointer == nullptr) return;
+
+    void* block = static_cast<char*>(pointer) - ALLOCATION_HEADER_SIZE;
+
+    AllocationCounters& counters = allocationCounters();
+    counters.numFrees++;
+    counters.bytesInUse -= *static_cast<std::size_t*>(block);
+
+    std::free(block);
+}
+
+
+void* operator new(std::size_t size) {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    countedFree(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    countedFree(pointer);
+}
+
+#endif
\ No newline at end of file
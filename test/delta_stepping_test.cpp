@@ -0,0 +1,70 @@
+// Delta stepping passes of IteratedDijkstraPropagation against the sequential Dijkstra passes
+// Random graphs with zero costs and grids large enough to relax on the worker pool must give
+// the same optimal subgraph and path weights for several deltas. A bottleneck monoid is not
+// additive, so it has to fall back to the sequential passes
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../include/iterated_dijkstra_propagation.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MONOIDS = 2;
+constexpr unsigned int NUM_GRAPHS = 40;
+constexpr unsigned int NUM_QUERIES = 15;
+
+
+unsigned int compareQueries(std::shared_ptr<MonoMulticostArray<int, NUM_MONOIDS>> multicostArray, const TestGraph<NUM_MONOIDS>& testGraph, unsigned int numQueries, std::mt19937& random) {
+    StaticMulticostGraph graph;
+    addEdges<NUM_MONOIDS>(graph, *multicostArray, testGraph.edges);
+
+    unsigned int numReachable = 0;
+
+    for (double delta : {0.5, 1.0, 8.0}) {
+        IteratedDijkstraPropagation deltaStepping(DeltaStepping{delta, 4});
+        numReachable += compareRandomQueries(deltaStepping, graph, multicostArray, testGraph.numNodes, numQueries, random);
+    }
+
+    return numReachable;
+}
+
+
+int main() {
+    std::mt19937 random(33);
+
+    auto additiveArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(false));
+
+    // Minimax (bottleneck) path first, the max of the edge costs under the min compare, then the sum
+    // Only the sum is additive
+    std::array<std::function<int(int a, int b)>, NUM_MONOIDS> compares = {
+        [](int a, int b) { return a - b; },
+        [](int a, int b) { return a - b; }
+    };
+    std::array<std::function<int(int a, int b)>, NUM_MONOIDS> ops = {
+        [](int a, int b) { return std::max(a, b); },
+        [](int a, int b) { return a + b; }
+    };
+    auto bottleneckArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(MonoMulticostProps<int, NUM_MONOIDS>({0, 0}, compares, ops, false, {false, true}));
+
+    CHECK(additiveArray->is_additive(0) && additiveArray->is_additive(1));
+    CHECK(!bottleneckArray->is_additive(0) && bottleneckArray->is_additive(1));
+
+    unsigned int numReachable = 0;
+
+    for (const TestGraph<NUM_MONOIDS>& testGraph : randomGraphs<NUM_MONOIDS>(NUM_GRAPHS, 84, 5, random)) {
+        numReachable += compareQueries(additiveArray, testGraph, NUM_QUERIES, random);
+        numReachable += compareQueries(bottleneckArray, testGraph, NUM_QUERIES, random);
+    }
+
+    // Wide wavefronts fill buckets with more than enough nodes for every pool thread
+    uint32_t side = 160;
+    numReachable += compareQueries(additiveArray, {side * side, gridEdges<NUM_MONOIDS>(side, side, 2, random)}, 2, random);
+
+    checkNumReachable(numReachable, NUM_GRAPHS);
+    return testResult();
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+// Early exit of IteratedDijkstraPropagation once the optimal subgraph is a single path
+// Diamonds whose tie sets collapse after monoid 0 or monoid 1 must skip the remaining monoids
+// and keep the lexicographic path, while a tie surviving every monoid must skip none
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+#include "../include/iterated_dijkstra_propagation.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MONOIDS = 3;
+
+
+// Runs the query monoid by monoid and lexicographically, checks the path, the optimal edges and the skipped monoids
+void checkQuery(const char* name, const std::vector<TestEdge<NUM_MONOIDS>>& edges, uint32_t start, uint32_t end,
+                const std::set<std::vector<uint32_t>>& expectedPaths, const std::set<std::pair<uint32_t, uint32_t>>& expectedEdges, unsigned int numSkipped) {
+    auto iteratedArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(false));
+    auto lexicographicArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(true));
+
+    StaticMulticostGraph iteratedGraph;
+    StaticMulticostGraph lexicographicGraph;
+    addEdges<NUM_MONOIDS>(iteratedGraph, *iteratedArray, edges);
+    addEdges<NUM_MONOIDS>(lexicographicGraph, *lexicographicArray, edges);
+
+    IteratedDijkstraPropagation pathfind;
+    QueryCancellation cancellation;
+
+    QueryProgress pathProgress;
+    std::vector<uint32_t> path = pathfind.getOptimalPath(iteratedGraph, iteratedArray, start, end, cancellation, pathProgress);
+
+    QueryProgress edgesProgress;
+    std::vector<uint32_t> optimalEdges = pathfind.getOptimalEdges(iteratedGraph, iteratedArray, start, end, cancellation, edgesProgress);
+
+    // A single Dijkstra on the whole multicost never skips, its path is the one of the full iteration
+    std::vector<uint32_t> lexicographicPath = pathfind.getOptimalPath(lexicographicGraph, lexicographicArray, start, end);
+
+    for (const QueryProgress& progress : {pathProgress, edgesProgress}) {
+        CHECK(progress.isComplete);
+        CHECK(progress.numMonoidsOptimal == NUM_MONOIDS);
+        CHECK(progress.numMonoidsSkipped == numSkipped);
+    }
+
+    CHECK(expectedPaths.count(path) > 0);
+    CHECK(expectedPaths.count(lexicographicPath) > 0);
+    CHECK(edgePairs(optimalEdges) == expectedEdges);
+
+    std::cout << name << ": " << pathProgress.numMonoidsSkipped << " monoids skipped" << std::endl;
+}
+
+
+int main() {
+    // Upper branch 0 -> 1 -> 3 and lower branch 0 -> 2 -> 3, which only differ on their first edge
+    auto diamond = [](std::array<int, NUM_MONOIDS> upperCost, std::array<int, NUM_MONOIDS> lowerCost) {
+        std::array<int, NUM_MONOIDS> unit = {1, 1, 1};
+        return std::vector<TestEdge<NUM_MONOIDS>>{
+            {0, 1, upperCost}, {1, 3, unit},
+            {0, 2, lowerCost}, {2, 3, unit}
+        };
+    };
+
+    // Monoid 0 already picks the upper branch, monoids 1 and 2 are skipped though they favor the lower one
+    checkQuery("collapse after monoid 0", diamond({1, 5, 5}, {2, 0, 0}), 0, 3,
+        {{0, 1, 3}}, {{0, 1}, {1, 3}}, 2);
+
+    // Tied on monoid 0, monoid 1 picks the lower branch and monoid 2 is skipped
+    checkQuery("collapse after monoid 1", diamond({1, 2, 0}, {1, 1, 5}), 0, 3,
+        {{0, 2, 3}}, {{0, 2}, {2, 3}}, 1);
+
+    // Tied on every monoid, both branches stay optimal and nothing is skipped
+    checkQuery("surviving branch", diamond({1, 1, 1}, {1, 1, 1}), 0, 3,
+        {{0, 1, 3}, {0, 2, 3}}, {{0, 1}, {1, 3}, {0, 2}, {2, 3}}, 0);
+
+    // A branch that only collapses at the last monoid has nothing left to skip
+    checkQuery("collapse at the last monoid", diamond({1, 1, 2}, {1, 1, 1}), 0, 3,
+        {{0, 2, 3}}, {{0, 2}, {2, 3}}, 0);
+
+    return testResult();
+}
\ No newline at end of file
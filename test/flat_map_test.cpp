@@ -0,0 +1,160 @@
+// FlatMap against std::map under random inserts and clears
+// Cleared keys must stay missing across an epoch wrap around and across rehashes that
+// run while stale slots of cleared keys remain, and keys inserted again must start from
+// a default value. References must hold while no new key is inserted, and values must
+// survive the rehashes of later inserts
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "../include/flat_map.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_ROUNDS = 40;
+
+
+// Starts the epoch right before it wraps around
+class WrappingFlatMap : public FlatMap<int> {
+public:
+    void setEpoch(uint32_t value) {
+        epoch = value;
+    };
+};
+
+
+void checkSame(const FlatMap<int>& map, const std::map<uint32_t, int>& expected, const std::vector<uint32_t>& missingKeys) {
+    CHECK(map.size() == expected.size());
+
+    for (const auto& [key, value] : expected) {
+        const int* found = map.find(key);
+        CHECK(found != nullptr && *found == value);
+    }
+
+    for (uint32_t key : missingKeys) {
+        if (expected.count(key) > 0) continue;
+        CHECK(!map.contains(key));
+        CHECK(map.find(key) == nullptr);
+    }
+}
+
+
+// Random keys from a small range so cleared keys come back, inserted and cleared over rounds
+void checkRounds(FlatMap<int>& map, unsigned int maxKeys, std::mt19937& random) {
+    std::vector<uint32_t> seenKeys;
+
+    for (unsigned int round = 0; round < NUM_ROUNDS; ++round) {
+        std::map<uint32_t, int> expected;
+        unsigned int numKeys = random() % maxKeys;
+
+        for (unsigned int i = 0; i < numKeys; ++i) {
+            uint32_t key = random() % (2 * maxKeys);
+
+            // A key inserted again after a clear must not see the value of its stale slot
+            if (expected.count(key) == 0) CHECK(map[key] == 0);
+
+            int value = static_cast<int>(random() % 1000) + 1;
+            map[key] = value;
+            expected[key] = value;
+            seenKeys.push_back(key);
+        }
+
+        checkSame(map, expected, seenKeys);
+        map.clear();
+        checkSame(map, {}, seenKeys);
+    }
+}
+
+
+void checkEpochWrap(std::mt19937& random) {
+    WrappingFlatMap map;
+
+    // Allocates the slots, since a rehash restarts the epoch
+    map.reserve(64);
+    map[7] = 1;
+    map.clear();
+
+    map.setEpoch(std::numeric_limits<uint32_t>::max() - NUM_ROUNDS / 2);
+    checkRounds(map, 40, random);
+}
+
+
+void checkStaleRehash(std::mt19937& random) {
+    FlatMap<int> map;
+
+    // Fills the table with keys that all go stale, then grows it several times over them
+    for (uint32_t key = 0; key < 12; ++key) map[key] = 1;
+    map.clear();
+
+    std::map<uint32_t, int> expected;
+    std::vector<uint32_t> missingKeys;
+    for (uint32_t key = 0; key < 12; ++key) missingKeys.push_back(key);
+
+    for (uint32_t i = 0; i < 500; ++i) {
+        uint32_t key = 1000 + random() % 5000;
+        int value = static_cast<int>(i) + 1;
+        map[key] = value;
+        expected[key] = value;
+    }
+
+    checkSame(map, expected, missingKeys);
+    map.clear();
+
+    // Growing with stale slots over rounds of mixed sizes
+    checkRounds(map, 300, random);
+}
+
+
+void checkReferences(std::mt19937& random) {
+    FlatMap<int> map;
+    std::map<uint32_t, int> expected;
+
+    for (uint32_t key = 0; key < 10; ++key) {
+        map[key] = static_cast<int>(key);
+        expected[key] = static_cast<int>(key);
+    }
+
+    // Lookups of existing keys do not insert, references stay valid
+    int& value = map[3];
+    int* found = map.find(3);
+    for (uint32_t key = 0; key < 10; ++key) map[key] += 0;
+    CHECK(map.find(7) != nullptr);
+    CHECK(&map.at(3) == &value && found == &value);
+
+    value = 42;
+    expected[3] = 42;
+    CHECK(map.at(3) == 42);
+
+    // New keys may move every value, which must keep its content
+    for (unsigned int i = 0; i < 1000; ++i) {
+        uint32_t key = random();
+        map[key] = static_cast<int>(i);
+        expected[key] = static_cast<int>(i);
+    }
+    checkSame(map, expected, {});
+
+    uint32_t missingKey = 0;
+    while (expected.count(missingKey) > 0) missingKey++;
+
+    bool isThrown = false;
+    try {
+        map.at(missingKey);
+    } catch (const std::out_of_range&) {
+        isThrown = true;
+    }
+    CHECK(isThrown);
+}
+
+
+int main() {
+    std::mt19937 random(38);
+
+    checkEpochWrap(random);
+    checkStaleRehash(random);
+    checkReferences(random);
+
+    return testResult();
+}
\ No newline at end of file
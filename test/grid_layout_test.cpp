@@ -0,0 +1,57 @@
+// Cell layouts of GridMap on grids of many shapes
+// Every layout must give each cell its own index below numCells, cellCoordinates must invert
+// cellIndex, and the padding of the curve layouts must stay within the last tiles
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "../include/grid_map.hpp"
+#include "test_support.hpp"
+
+
+void checkLayout(int width, int height, GridLayout layout) {
+    GridMap map(width, height, layout);
+
+    std::vector<uint8_t> isUsed(map.numCells(), 0);
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint32_t index = map.cellIndex(x, y);
+            CHECK(index < map.numCells());
+            if (index >= map.numCells()) continue;
+
+            CHECK(!isUsed[index]);
+            isUsed[index] = 1;
+
+            int cellX = -1;
+            int cellY = -1;
+            map.cellCoordinates(index, cellX, cellY);
+            CHECK(cellX == x && cellY == y);
+        }
+    }
+
+    // Padding cells are obstacles, the grid cells are free
+    for (uint32_t index = 0; index < map.numCells(); ++index) CHECK(map.isObstacleAt(index) == !isUsed[index]);
+
+    // At most one row and one column of tiles of 256 cells per side are padded
+    uint64_t paddedWidth = width + 255;
+    uint64_t paddedHeight = height + 255;
+    CHECK(map.numCells() <= paddedWidth * paddedHeight);
+}
+
+
+int main() {
+    int shapes[][2] = {{1, 1}, {3, 5}, {17, 4}, {64, 64}, {100, 37}, {256, 256}, {257, 3}, {300, 700}, {1030, 260}};
+
+    for (auto& shape : shapes) {
+        for (GridLayout layout : {GridLayout::ROW_MAJOR, GridLayout::Z_ORDER, GridLayout::HILBERT}) {
+            checkLayout(shape[0], shape[1], layout);
+        }
+    }
+
+    // A long strip no longer pads to the square of its length
+    GridMap strip(4096, 8, GridLayout::HILBERT);
+    CHECK(strip.numCells() == 4096u * 256u);
+
+    return testResult();
+}
@@ -0,0 +1,92 @@
+// Obstacle counts of GridMap patched by setObstacle against counts swept from scratch
+// After every batch of random edits, including cells set again to what they already are,
+// each cell must count the obstacles among its four neighbors inside the grid, the same as a
+// map filled by setObstacles on the same cells, in every layout
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "../include/grid_map.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_BATCHES = 20;
+
+
+int naiveCount(const std::vector<bool>& obstacles, int width, int height, int x, int y) {
+    int count = 0;
+    if (y > 0) count += obstacles[(y - 1) * width + x];
+    if (y + 1 < height) count += obstacles[(y + 1) * width + x];
+    if (x > 0) count += obstacles[y * width + x - 1];
+    if (x + 1 < width) count += obstacles[y * width + x + 1];
+    return count;
+}
+
+
+void checkCounts(const GridMap& map, const std::vector<bool>& obstacles, GridLayout layout) {
+    int width = map.getWidth();
+    int height = map.getHeight();
+
+    GridMap swept(width, height, layout);
+    swept.setObstacles(obstacles);
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint32_t index = map.cellIndex(x, y);
+            CHECK(map.isObstacle(x, y) == obstacles[y * width + x]);
+            CHECK(map.getObstacleCount(index) == naiveCount(obstacles, width, height, x, y));
+            CHECK(map.getObstacleCount(index) == swept.getObstacleCount(swept.cellIndex(x, y)));
+        }
+    }
+}
+
+
+void checkRandomEdits(int width, int height, GridLayout layout, std::mt19937& random) {
+    GridMap map(width, height, layout);
+    std::vector<bool> obstacles(width * height, false);
+
+    for (unsigned int batch = 0; batch < NUM_BATCHES; ++batch) {
+        // Dense batches early, so cells are cleared as often as they are set
+        bool isObstacleLikely = batch < NUM_BATCHES / 2;
+        unsigned int numEdits = 1 + random() % (width * height);
+
+        for (unsigned int i = 0; i < numEdits; ++i) {
+            int x = random() % width;
+            int y = random() % height;
+            bool isObstacle = isObstacleLikely ? random() % 4 != 0 : random() % 4 == 0;
+
+            map.setObstacle(x, y, isObstacle);
+            obstacles[y * width + x] = isObstacle;
+        }
+
+        checkCounts(map, obstacles, layout);
+    }
+
+    // Counts patched after a full sweep
+    map.setObstacles(obstacles);
+    for (unsigned int i = 0; i < 50; ++i) {
+        int x = random() % width;
+        int y = random() % height;
+        bool isObstacle = !obstacles[y * width + x];
+
+        map.setObstacle(x, y, isObstacle);
+        obstacles[y * width + x] = isObstacle;
+    }
+
+    checkCounts(map, obstacles, layout);
+}
+
+
+int main() {
+    std::mt19937 random(42);
+
+    int shapes[][2] = {{1, 1}, {1, 9}, {9, 1}, {2, 2}, {7, 5}, {33, 17}, {64, 64}, {70, 130}};
+
+    for (auto& shape : shapes) {
+        for (GridLayout layout : {GridLayout::ROW_MAJOR, GridLayout::Z_ORDER, GridLayout::HILBERT}) {
+            checkRandomEdits(shape[0], shape[1], layout, random);
+        }
+    }
+
+    return testResult();
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+// HierarchicalGridPlanner against flat IDP on small random maps
+// Planner paths must be valid, reach the same queries as flat IDP and never beat its optimum.
+// With a single cluster covering the whole map, the planner must find the flat optimum itself
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../include/grid_map.hpp"
+#include "../include/grid_state.hpp"
+#include "../include/hierarchical_grid_planner.hpp"
+#include "../include/iterated_dijkstra_propagation.hpp"
+#include "../include/single_optimal_path_finder.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MONOIDS = 2;
+constexpr unsigned int NUM_MAPS = 12;
+constexpr unsigned int NUM_QUERIES = 25;
+
+const std::array<int, NUM_MONOIDS> IDENTITY = {0, 0};
+const std::array<std::function<int(int a, int b)>, NUM_MONOIDS> COMPARES = {
+    [](int a, int b) { return a - b; },
+    [](int a, int b) { return a - b; }
+};
+const std::array<std::function<int(int a, int b)>, NUM_MONOIDS> OPS = {
+    [](int a, int b) { return a + b; },
+    [](int a, int b) { return a + b; }
+};
+// Distance first, then the obstacles next to the cells entered
+const std::array<std::function<int(GridState& a, GridState& b)>, NUM_MONOIDS> COMPUTES = {
+    [](GridState&, GridState&) { return 1; },
+    [](GridState&, GridState& b) { return b.numberOfNearbyObstacles(); }
+};
+
+
+// Cost of a path of free adjacent cells from start to end, false if it is not one
+bool gridPathCost(const GridMap& map, std::vector<GridState>& path, GridState& start, GridState& end, std::array<int, NUM_MONOIDS>& cost) {
+    cost = IDENTITY;
+    if (path.empty()) return false;
+    if (path.front().getUniqueId() != start.getUniqueId() || path.back().getUniqueId() != end.getUniqueId()) return false;
+
+    for (unsigned int i = 0; i < path.size(); ++i) {
+        if (map.isObstacle(path[i].x, path[i].y)) return false;
+        if (i == 0) continue;
+
+        if (std::abs(path[i].x - path[i - 1].x) + std::abs(path[i].y - path[i - 1].y) != 1) return false;
+        for (unsigned int k = 0; k < NUM_MONOIDS; ++k) cost[k] = OPS[k](cost[k], COMPUTES[k](path[i - 1], path[i]));
+    }
+    return true;
+}
+
+
+unsigned int compareQueries(std::shared_ptr<GridMap> map, int clusterSize, std::mt19937& random) {
+    HierarchicalGridPlanner<int, NUM_MONOIDS> planner(map, IDENTITY, COMPARES, OPS, COMPUTES, clusterSize);
+    planner.preprocess();
+
+    SingleOptimalPathFinder<GridState> flatFinder(IDENTITY, COMPARES, OPS, COMPUTES);
+    IteratedDijkstraPropagation pathfind;
+
+    bool isSingleCluster = clusterSize >= map->getWidth() && clusterSize >= map->getHeight();
+    unsigned int numReachable = 0;
+
+    for (unsigned int q = 0; q < NUM_QUERIES; ++q) {
+        GridState start(*map, random() % map->getWidth(), random() % map->getHeight());
+        GridState end(*map, random() % map->getWidth(), random() % map->getHeight());
+        if (map->isObstacle(start.x, start.y) || map->isObstacle(end.x, end.y)) continue;
+        if (start.getUniqueId() == end.getUniqueId()) continue;
+
+        std::vector<GridState> flatPath = flatFinder.getOptimalPath(pathfind, start, end);
+        std::vector<GridState> plannerPath = planner.getOptimalPath(start, end);
+
+        CHECK(plannerPath.empty() == flatPath.empty());
+        if (flatPath.empty() || plannerPath.empty()) continue;
+        numReachable++;
+
+        std::array<int, NUM_MONOIDS> flatCost;
+        std::array<int, NUM_MONOIDS> plannerCost;
+        CHECK(gridPathCost(*map, flatPath, start, end, flatCost));
+        CHECK(gridPathCost(*map, plannerPath, start, end, plannerCost));
+
+        // Crossing clusters through entrances can only cost more
+        if (isSingleCluster) {
+            CHECK(plannerCost == flatCost);
+        } else {
+            CHECK(!(plannerCost < flatCost));
+        }
+    }
+
+    return numReachable;
+}
+
+
+int main() {
+    std::mt19937 random(32);
+
+    unsigned int numReachable = 0;
+
+    for (unsigned int m = 0; m < NUM_MAPS; ++m) {
+        int width = 12 + random() % 20;
+        int height = 12 + random() % 20;
+
+        auto map = std::make_shared<GridMap>(width, height);
+        for (int i = 0; i < width * height / 5; ++i) map->setObstacle(random() % width, random() % height, true);
+
+        numReachable += compareQueries(map, 4, random);
+        numReachable += compareQueries(map, 7, random);
+        numReachable += compareQueries(map, 32, random);
+    }
+
+    checkNumReachable(numReachable, NUM_MAPS);
+    return testResult();
+}
@@ -0,0 +1,110 @@
+// IdpEngine on a CompactGraph snapshot against IteratedDijkstraPropagation on the same graph
+// On random graphs with zero costs and on grids, both must find the same optimal edges,
+// skip the same monoids and return paths of the same multicost made of optimal edges
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "../include/idp_engine.hpp"
+#include "../include/iterated_dijkstra_propagation.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MONOIDS = 3;
+constexpr unsigned int NUM_GRAPHS = 30;
+constexpr unsigned int NUM_QUERIES = 20;
+
+using Costs = AdditiveCosts<int, NUM_MONOIDS>;
+
+
+unsigned int compareQueries(const TestGraph<NUM_MONOIDS>& testGraph, std::mt19937& random) {
+    auto multicostArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(false));
+    StaticMulticostGraph graph;
+    addEdges<NUM_MONOIDS>(graph, *multicostArray, testGraph.edges);
+
+    // Random graphs are not strongly connected, every node seeds the snapshot
+    std::vector<uint32_t> seeds;
+    for (uint32_t node = 0; node < testGraph.numNodes; ++node) seeds.push_back(node);
+
+    std::vector<uint32_t> nodeIds;
+    CompactGraph<Costs> compactGraph = buildCompactGraph<Costs>(graph, *multicostArray, seeds, nodeIds);
+    CHECK(compactGraph.numNodes() == testGraph.numNodes);
+    CHECK(compactGraph.numEdges() == testGraph.edges.size());
+
+    std::vector<uint32_t> nodeIndices(testGraph.numNodes);
+    for (uint32_t index = 0; index < nodeIds.size(); ++index) nodeIndices[nodeIds[index]] = index;
+
+    // Node pairs of the engine edges, by edge id
+    std::vector<std::pair<uint32_t, uint32_t>> enginePairs(compactGraph.numEdges());
+    for (uint32_t node = 0; node < compactGraph.numNodes(); ++node) {
+        for (const auto& edge : compactGraph.getNextEdges(node)) enginePairs[edge.id] = {nodeIds[edge.frNode], nodeIds[edge.toNode]};
+    }
+
+    std::map<std::pair<uint32_t, uint32_t>, std::array<int, NUM_MONOIDS>> costs = edgeCosts<NUM_MONOIDS>(testGraph.edges);
+
+    IdpEngine<CompactGraph<Costs>, Costs> engine(compactGraph);
+    IteratedDijkstraPropagation reference;
+    QueryCancellation cancellation;
+    unsigned int numReachable = 0;
+
+    for (unsigned int q = 0; q < NUM_QUERIES; ++q) {
+        uint32_t start = random() % testGraph.numNodes;
+        uint32_t end = random() % testGraph.numNodes;
+        if (start == end) continue;
+
+        QueryProgress progress;
+        std::set<std::pair<uint32_t, uint32_t>> expectedEdges = edgePairs(reference.getOptimalEdges(graph, multicostArray, start, end, cancellation, progress));
+
+        std::set<std::pair<uint32_t, uint32_t>> engineEdges;
+        for (uint32_t edgeId : engine.getOptimalEdges(nodeIndices[start], nodeIndices[end])) engineEdges.insert(enginePairs[edgeId]);
+
+        CHECK(engineEdges == expectedEdges);
+        CHECK(engine.getNumMonoidsSkipped() == progress.numMonoidsSkipped);
+
+        std::vector<uint32_t> expectedPath = reference.getOptimalPath(graph, multicostArray, start, end);
+        std::vector<uint32_t> enginePath;
+        bool isReachable = engine.getOptimalPath(nodeIndices[start], nodeIndices[end], enginePath);
+
+        CHECK(isReachable == !expectedPath.empty());
+        if (!isReachable || expectedPath.empty()) continue;
+        numReachable++;
+
+        for (uint32_t& node : enginePath) node = nodeIds[node];
+        CHECK(enginePath.front() == start && enginePath.back() == end);
+
+        for (unsigned int i = 0; i + 1 < enginePath.size(); ++i) {
+            CHECK(expectedEdges.count({enginePath[i], enginePath[i + 1]}) > 0);
+        }
+
+        std::array<int, NUM_MONOIDS> expectedCost;
+        std::array<int, NUM_MONOIDS> engineCost;
+        CHECK(pathCost<NUM_MONOIDS>(costs, expectedPath, expectedCost));
+        CHECK(pathCost<NUM_MONOIDS>(costs, enginePath, engineCost));
+        CHECK(engineCost == expectedCost);
+    }
+
+    return numReachable;
+}
+
+
+int main() {
+    std::mt19937 random(36);
+
+    unsigned int numReachable = 0;
+
+    for (const TestGraph<NUM_MONOIDS>& testGraph : randomGraphs<NUM_MONOIDS>(NUM_GRAPHS, 44, 3, random)) {
+        numReachable += compareQueries(testGraph, random);
+    }
+
+    for (const TestGraph<NUM_MONOIDS>& testGraph : gridGraphs<NUM_MONOIDS>(NUM_GRAPHS / 3, 14, 2, random)) {
+        numReachable += compareQueries(testGraph, random);
+    }
+
+    checkNumReachable(numReachable, NUM_GRAPHS);
+    return testResult();
+}
\ No newline at end of file
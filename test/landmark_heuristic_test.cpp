@@ -0,0 +1,104 @@
+// IteratedDijkstraPropagation goal directed by a LandmarkHeuristic against plain IDP
+// On random graphs with zero costs and on grids, the bounds of every monoid must stay below
+// the exact single monoid costs, and the goal directed searches must find the same optimal
+// subgraph and path weights, iterating monoid by monoid or on the whole lexicographic multicost
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../include/iterated_dijkstra_propagation.hpp"
+#include "../include/landmark_heuristic.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MONOIDS = 2;
+constexpr unsigned int NUM_GRAPHS = 30;
+constexpr unsigned int NUM_QUERIES = 20;
+constexpr int NO_PATH = std::numeric_limits<int>::max();
+
+
+// Floyd-Warshall on the monoid at index alone
+std::vector<std::vector<int>> exactCosts(const TestGraph<NUM_MONOIDS>& testGraph, unsigned int index) {
+    std::vector<std::vector<int>> costs(testGraph.numNodes, std::vector<int>(testGraph.numNodes, NO_PATH));
+
+    for (uint32_t node = 0; node < testGraph.numNodes; ++node) costs[node][node] = 0;
+    for (const TestEdge<NUM_MONOIDS>& edge : testGraph.edges) {
+        costs[edge.frNode][edge.toNode] = std::min(costs[edge.frNode][edge.toNode], edge.cost[index]);
+    }
+
+    for (uint32_t via = 0; via < testGraph.numNodes; ++via) {
+        for (uint32_t frNode = 0; frNode < testGraph.numNodes; ++frNode) {
+            if (costs[frNode][via] == NO_PATH) continue;
+
+            for (uint32_t toNode = 0; toNode < testGraph.numNodes; ++toNode) {
+                if (costs[via][toNode] == NO_PATH) continue;
+                costs[frNode][toNode] = std::min(costs[frNode][toNode], costs[frNode][via] + costs[via][toNode]);
+            }
+        }
+    }
+
+    return costs;
+}
+
+
+void checkAdmissible(LandmarkHeuristic<int, NUM_MONOIDS>& heuristic, MonoMulticostArray<int, NUM_MONOIDS>& multicostArray, const TestGraph<NUM_MONOIDS>& testGraph) {
+    std::unique_ptr<MulticostID> bound = multicostArray.identity();
+
+    for (unsigned int k = 0; k < NUM_MONOIDS; ++k) {
+        std::vector<std::vector<int>> costs = exactCosts(testGraph, k);
+
+        for (uint32_t frNode = 0; frNode < testGraph.numNodes; ++frNode) {
+            for (uint32_t toNode = 0; toNode < testGraph.numNodes; ++toNode) {
+                heuristic.lowerBound(frNode, toNode, k, bound);
+                int value = multicostArray.get_values(bound)[k];
+
+                CHECK(value >= 0);
+                if (costs[frNode][toNode] != NO_PATH) CHECK(value <= costs[frNode][toNode]);
+            }
+        }
+    }
+}
+
+
+unsigned int compareQueries(const TestGraph<NUM_MONOIDS>& testGraph, bool isLexicographic, std::mt19937& random) {
+    auto multicostArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(isLexicographic));
+    StaticMulticostGraph graph;
+    addEdges<NUM_MONOIDS>(graph, *multicostArray, testGraph.edges);
+
+    // Random graphs are not strongly connected, every node seeds the tables
+    std::vector<uint32_t> seeds;
+    for (uint32_t node = 0; node < testGraph.numNodes; ++node) seeds.push_back(node);
+
+    auto heuristic = std::make_shared<LandmarkHeuristic<int, NUM_MONOIDS>>(4);
+    heuristic->preprocess(graph, multicostArray, seeds);
+    CHECK(heuristic->getLandmarks().size() > 0);
+
+    checkAdmissible(*heuristic, *multicostArray, testGraph);
+
+    IteratedDijkstraPropagation goalDirected(heuristic);
+    return compareRandomQueries(goalDirected, graph, multicostArray, testGraph.numNodes, NUM_QUERIES, random);
+}
+
+
+int main() {
+    std::mt19937 random(31);
+
+    unsigned int numReachable = 0;
+
+    for (const TestGraph<NUM_MONOIDS>& testGraph : randomGraphs<NUM_MONOIDS>(NUM_GRAPHS, 44, 3, random)) {
+        numReachable += compareQueries(testGraph, false, random);
+        numReachable += compareQueries(testGraph, true, random);
+    }
+
+    for (const TestGraph<NUM_MONOIDS>& testGraph : gridGraphs<NUM_MONOIDS>(NUM_GRAPHS / 3, 14, 2, random)) {
+        numReachable += compareQueries(testGraph, false, random);
+        numReachable += compareQueries(testGraph, true, random);
+    }
+
+    checkNumReachable(numReachable, NUM_GRAPHS);
+    return testResult();
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+// Differential test of the lexicographic fast path of IteratedDijkstraPropagation
+// On random graphs the single lexicographic Dijkstra must find a path of the same weights as
+// the full monoid by monoid propagation, made only of edges of its optimal subgraph
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "../include/iterated_dijkstra_propagation.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MONOIDS = 3;
+constexpr unsigned int NUM_GRAPHS = 60;
+constexpr unsigned int NUM_QUERIES = 20;
+
+
+// Bellman-Ford on lexicographically ordered cost arrays
+bool referenceCost(uint32_t numNodes, const std::vector<TestEdge<NUM_MONOIDS>>& edges, uint32_t start, uint32_t end, std::array<int, NUM_MONOIDS>& cost) {
+    std::vector<std::array<int, NUM_MONOIDS>> weights(numNodes);
+    std::vector<bool> isReached(numNodes, false);
+
+    weights[start].fill(0);
+    isReached[start] = true;
+
+    for (uint32_t round = 0; round < numNodes; ++round) {
+        for (const TestEdge<NUM_MONOIDS>& edge : edges) {
+            if (!isReached[edge.frNode]) continue;
+
+            std::array<int, NUM_MONOIDS> weight;
+            for (unsigned int k = 0; k < NUM_MONOIDS; ++k) weight[k] = weights[edge.frNode][k] + edge.cost[k];
+
+            if (!isReached[edge.toNode] || weight < weights[edge.toNode]) {
+                weights[edge.toNode] = weight;
+                isReached[edge.toNode] = true;
+            }
+        }
+    }
+
+    cost = weights[end];
+    return isReached[end];
+}
+
+
+int main() {
+    std::mt19937 random(29);
+
+    auto lexicographicArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(true));
+    auto iteratedArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(false));
+
+    IteratedDijkstraPropagation pathfind;
+
+    unsigned int numReachable = 0;
+
+    // Small costs give many ties between the monoids
+    for (const TestGraph<NUM_MONOIDS>& testGraph : randomGraphs<NUM_MONOIDS>(NUM_GRAPHS, 44, 3, random)) {
+        uint32_t numNodes = testGraph.numNodes;
+        const std::vector<TestEdge<NUM_MONOIDS>>& edges = testGraph.edges;
+        auto costs = edgeCosts<NUM_MONOIDS>(edges);
+
+        StaticMulticostGraph lexicographicGraph;
+        StaticMulticostGraph iteratedGraph;
+        addEdges<NUM_MONOIDS>(lexicographicGraph, *lexicographicArray, edges);
+        addEdges<NUM_MONOIDS>(iteratedGraph, *iteratedArray, edges);
+
+        for (unsigned int q = 0; q < NUM_QUERIES; ++q) {
+            uint32_t start = random() % numNodes;
+            uint32_t end = random() % numNodes;
+            if (start == end) continue;
+
+            std::vector<uint32_t> lexicographicPath = pathfind.getOptimalPath(lexicographicGraph, lexicographicArray, start, end);
+            std::vector<uint32_t> iteratedPath = pathfind.getOptimalPath(iteratedGraph, iteratedArray, start, end);
+
+            std::array<int, NUM_MONOIDS> expectedCost;
+            bool isReachable = referenceCost(numNodes, edges, start, end, expectedCost);
+
+            CHECK(lexicographicPath.empty() != isReachable);
+            CHECK(iteratedPath.empty() != isReachable);
+            if (!isReachable || lexicographicPath.empty() || iteratedPath.empty()) continue;
+            numReachable++;
+
+            CHECK(lexicographicPath.front() == start && lexicographicPath.back() == end);
+            CHECK(iteratedPath.front() == start && iteratedPath.back() == end);
+
+            std::array<int, NUM_MONOIDS> lexicographicCost;
+            std::array<int, NUM_MONOIDS> iteratedCost;
+            CHECK(pathCost<NUM_MONOIDS>(costs, lexicographicPath, lexicographicCost));
+            CHECK(pathCost<NUM_MONOIDS>(costs, iteratedPath, iteratedCost));
+
+            CHECK(lexicographicCost == expectedCost);
+            CHECK(iteratedCost == expectedCost);
+
+            // Ties can pick different paths, but all of them lie in the optimal subgraph
+            std::set<std::pair<uint32_t, uint32_t>> optimalPairs = edgePairs(pathfind.getOptimalEdges(iteratedGraph, iteratedArray, start, end));
+
+            for (unsigned int i = 0; i + 1 < lexicographicPath.size(); ++i) {
+                CHECK(optimalPairs.count({lexicographicPath[i], lexicographicPath[i + 1]}) > 0);
+            }
+        }
+    }
+
+    checkNumReachable(numReachable, NUM_GRAPHS);
+    return testResult();
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+// MovingAI map and scenario loaders on small files written next to the test
+// Scenario rows with missing fields, coordinates outside their map or another map size are rejected
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../include/grid_map.hpp"
+#include "../include/moving_ai_benchmark.hpp"
+#include "test_support.hpp"
+
+
+static void writeFile(const std::string& path, const std::string& contents) {
+    std::ofstream file(path, std::ios::binary);
+    file << contents;
+}
+
+
+static bool loadScenarioRows(const std::string& rows, const GridMap& map, std::vector<MovingAiScenario>& scenarios) {
+    writeFile("moving_ai_loader_test.map.scen", "version 1\n" + rows);
+    return loadMovingAiScenarios("moving_ai_loader_test.map.scen", map, scenarios);
+}
+
+
+int main() {
+    writeFile("moving_ai_loader_test.map", "type octile\nheight 3\nwidth 4\nmap\n....\n.@@.\nS..G\n");
+
+    std::shared_ptr<GridMap> map;
+    CHECK(loadMovingAiMap("moving_ai_loader_test.map", map));
+    if (map == nullptr) return testResult();
+
+    CHECK(map->getWidth() == 4 && map->getHeight() == 3);
+    CHECK(map->isObstacle(1, 1) && map->isObstacle(2, 1));
+    CHECK(!map->isObstacle(0, 2) && !map->isObstacle(3, 2));
+
+    std::vector<MovingAiScenario> scenarios;
+
+    CHECK(loadScenarioRows("0\tt.map\t4\t3\t0\t0\t3\t2\t5\n\n1\tt.map\t4\t3\t3\t0\t0\t2\t5.41421356\n", *map, scenarios));
+    CHECK(scenarios.size() == 2);
+    if (scenarios.size() == 2) {
+        CHECK(scenarios[1].bucket == 1 && scenarios[1].mapWidth == 4 && scenarios[1].mapHeight == 3);
+        CHECK(scenarios[1].startX == 3 && scenarios[1].goalY == 2);
+    }
+
+    // Missing length, goal outside the map, negative start, and a row made for a larger map
+    std::cerr << "expected errors:" << std::endl;
+    CHECK(!loadScenarioRows("0\tt.map\t4\t3\t0\t0\t3\t2\n", *map, scenarios));
+    CHECK(!loadScenarioRows("0\tt.map\t4\t3\t0\t0\t4\t2\t5\n", *map, scenarios));
+    CHECK(!loadScenarioRows("0\tt.map\t4\t3\t-1\t0\t3\t2\t5\n", *map, scenarios));
+    CHECK(!loadScenarioRows("0\tt.map\t8\t8\t0\t0\t3\t2\t5\n", *map, scenarios));
+
+    // Without the map only the size of the row bounds its coordinates
+    writeFile("moving_ai_loader_test.map.scen", "version 1\n0\tt.map\t8\t8\t7\t7\t3\t2\t5\n");
+    CHECK(loadMovingAiScenarios("moving_ai_loader_test.map.scen", scenarios));
+
+    return testResult();
+}
@@ -0,0 +1,148 @@
+// Counts the heap allocations of IteratedDijkstraPropagation queries through a QueryWorkspace
+// Once a first query has warmed the workspace and explored the graph, the same query again
+// must not allocate, with the sequential and the delta stepping passes. Also checks that a thread returns its pooled multicost ids when it exits
+
+#include "counting_allocator.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../include/grid_map.hpp"
+#include "../include/grid_state.hpp"
+#include "../include/iterated_dijkstra_propagation.hpp"
+#include "../include/query_workspace.hpp"
+#include "../include/single_optimal_path_finder.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MONOIDS = 2;
+
+
+// Allocations made by the second of two identical queries run by query
+uint64_t repeatedQueryAllocations(const std::function<void()>& query) {
+    query();
+
+    uint64_t numAllocations = allocationCounters().numAllocations;
+    query();
+    return allocationCounters().numAllocations - numAllocations;
+}
+
+
+void checkStaticGraphQuery() {
+    std::mt19937 random(35);
+    uint32_t side = 40;
+
+    auto multicostArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(false));
+    StaticMulticostGraph graph;
+    addEdges<NUM_MONOIDS>(graph, *multicostArray, gridEdges<NUM_MONOIDS>(side, side, 1, random));
+
+    IteratedDijkstraPropagation pathfind;
+    QueryWorkspace workspace;
+    QueryCancellation cancellation;
+    QueryProgress progress;
+    std::vector<uint32_t> path;
+
+    uint64_t numAllocations = repeatedQueryAllocations([&]() {
+        pathfind.getOptimalPath(graph, multicostArray, 0, side * side - 1, path, workspace, cancellation, progress);
+    });
+
+    CHECK(path.size() > 0);
+    CHECK(progress.numMonoidsOptimal == NUM_MONOIDS);
+    CHECK(numAllocations == 0);
+    std::cout << "static graph query: " << numAllocations << " allocations" << std::endl;
+}
+
+
+// Wide grid wavefronts relax the delta stepping buckets on the worker pool
+void checkDeltaSteppingQuery() {
+    std::mt19937 random(351);
+    uint32_t side = 160;
+
+    auto multicostArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(false));
+    StaticMulticostGraph graph;
+    addEdges<NUM_MONOIDS>(graph, *multicostArray, gridEdges<NUM_MONOIDS>(side, side, 2, random));
+
+    IteratedDijkstraPropagation pathfind(DeltaStepping{8.0, 4});
+    QueryWorkspace workspace;
+    QueryCancellation cancellation;
+    QueryProgress progress;
+    std::vector<uint32_t> path;
+
+    uint64_t numAllocations = repeatedQueryAllocations([&]() {
+        pathfind.getOptimalPath(graph, multicostArray, 0, side * side - 1, path, workspace, cancellation, progress);
+    });
+
+    CHECK(path.size() > 0);
+    CHECK(progress.isComplete);
+    CHECK(numAllocations == 0);
+    std::cout << "delta stepping query: " << numAllocations << " allocations" << std::endl;
+}
+
+
+void checkLazyGridQuery() {
+    std::mt19937 random(350);
+    int side = 48;
+
+    GridMap map(side, side);
+    for (int i = 0; i < side * side / 6; ++i) map.setObstacle(random() % side, random() % side, true);
+    map.setObstacle(0, 0, false);
+    map.setObstacle(side - 1, side - 1, false);
+
+    SingleOptimalPathFinder<GridState> pathFinder(
+        std::array<int, NUM_MONOIDS>{0, 0},
+        std::array<std::function<int(int a, int b)>, NUM_MONOIDS>{[](int a, int b) { return a - b; }, [](int a, int b) { return a - b; }},
+        std::array<std::function<int(int a, int b)>, NUM_MONOIDS>{[](int a, int b) { return a + b; }, [](int a, int b) { return a + b; }},
+        std::array<std::function<int(GridState& a, GridState& b)>, NUM_MONOIDS>{
+            [](GridState&, GridState&) { return 1; },
+            [](GridState&, GridState& b) { return b.numberOfNearbyObstacles(); }
+        }
+    );
+
+    IteratedDijkstraPropagation pathfind;
+    QueryWorkspace workspace;
+    QueryCancellation cancellation;
+    QueryProgress progress;
+    std::vector<uint32_t> rawPath;
+    std::vector<GridState> statesPath;
+
+    uint64_t numAllocations = repeatedQueryAllocations([&]() {
+        pathFinder.getOptimalPath(pathfind, GridState(map, 0, 0), GridState(map, side - 1, side - 1), rawPath, statesPath, workspace, cancellation, progress);
+    });
+
+    CHECK(statesPath.size() > 0);
+    CHECK(numAllocations == 0);
+    std::cout << "lazy grid query: " << numAllocations << " allocations" << std::endl;
+}
+
+
+void checkThreadExitFreesIds() {
+    int64_t bytesInUse = allocationCounters().bytesInUse;
+
+    std::thread thread([]() {
+        auto multicostArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(false));
+
+        std::vector<std::unique_ptr<MulticostID>> ids;
+        for (int i = 0; i < 1000; ++i) ids.push_back(multicostArray->make_multicost({i, i}));
+
+        // Released ids go to the free list of this thread
+        ids.clear();
+    });
+    thread.join();
+
+    CHECK(allocationCounters().bytesInUse == bytesInUse);
+}
+
+
+int main() {
+    checkStaticGraphQuery();
+    checkDeltaSteppingQuery();
+    checkLazyGridQuery();
+    checkThreadExitFreesIds();
+
+    return testResult();
+}
\ No newline at end of file
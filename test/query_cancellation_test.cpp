@@ -0,0 +1,228 @@
+// Anytime queries of IteratedDijkstraPropagation cancelled part way through the monoids
+// A query cancelled while iterating monoid k must report k optimal monoids, not be complete and
+// return the optimal subgraph of the first k monoids, with a path made of its edges.
+// Deadlines that pass during a query must leave the same kind of result for whatever k was reached
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "../include/iterated_dijkstra_propagation.hpp"
+#include "../include/query_cancellation.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MONOIDS = 3;
+constexpr unsigned int NUM_GRIDS = 12;
+constexpr unsigned int NUM_QUERIES = 15;
+
+
+// Raised by the first compare of monoid cancelMonoid, which only runs once the query iterates it
+std::atomic<bool> cancelFlag(false);
+unsigned int cancelMonoid = NUM_MONOIDS;
+
+
+MonoMulticostProps<int, NUM_MONOIDS> cancellingProps() {
+    std::array<std::function<int(int a, int b)>, NUM_MONOIDS> compares;
+    for (unsigned int k = 0; k < NUM_MONOIDS; ++k) {
+        compares[k] = [k](int a, int b) {
+            if (k == cancelMonoid) cancelFlag = true;
+            return a - b;
+        };
+    }
+
+    std::array<std::function<int(int a, int b)>, NUM_MONOIDS> ops;
+    for (unsigned int k = 0; k < NUM_MONOIDS; ++k) ops[k] = [](int a, int b) { return a + b; };
+
+    return MonoMulticostProps<int, NUM_MONOIDS>({0, 0, 0}, compares, ops, false);
+}
+
+
+// Optimal edges of the query on the first K monoids of edges
+template<unsigned int K>
+std::set<std::pair<uint32_t, uint32_t>> restrictedEdges(const std::vector<TestEdge<NUM_MONOIDS>>& edges, uint32_t start, uint32_t end) {
+    if constexpr (K == 0) {
+        return {};
+    } else {
+        auto multicostArray = std::make_shared<MonoMulticostArray<int, K>>(additiveProps<K>(false));
+        StaticMulticostGraph graph;
+
+        for (const TestEdge<NUM_MONOIDS>& edge : edges) {
+            std::array<int, K> cost;
+            for (unsigned int k = 0; k < K; ++k) cost[k] = edge.cost[k];
+            graph.addEdge(edge.frNode, edge.toNode, multicostArray->make_multicost(std::move(cost)));
+        }
+
+        IteratedDijkstraPropagation reference;
+        return edgePairs(reference.getOptimalEdges(graph, multicostArray, start, end));
+    }
+}
+
+
+std::set<std::pair<uint32_t, uint32_t>> restrictedEdges(unsigned int numMonoids, const std::vector<TestEdge<NUM_MONOIDS>>& edges, uint32_t start, uint32_t end) {
+    switch (numMonoids) {
+        case 0: return restrictedEdges<0>(edges, start, end);
+        case 1: return restrictedEdges<1>(edges, start, end);
+        case 2: return restrictedEdges<2>(edges, start, end);
+        default: return restrictedEdges<3>(edges, start, end);
+    }
+}
+
+
+// Checks the edges and path of a cancelled query against the subgraph of its optimal monoids
+void checkCancelledQuery(const std::vector<TestEdge<NUM_MONOIDS>>& edges, uint32_t start, uint32_t end, const std::vector<uint32_t>& optimalEdges, const std::vector<uint32_t>& path, const QueryProgress& progress) {
+    CHECK(!progress.isComplete);
+    CHECK(progress.numMonoidsOptimal < NUM_MONOIDS);
+    CHECK(progress.numMonoidsSkipped == 0);
+
+    std::set<std::pair<uint32_t, uint32_t>> expectedEdges = restrictedEdges(progress.numMonoidsOptimal, edges, start, end);
+    CHECK(edgePairs(optimalEdges) == expectedEdges);
+
+    CHECK(path.empty() == expectedEdges.empty());
+    if (path.empty()) return;
+
+    CHECK(path.front() == start && path.back() == end);
+    for (unsigned int i = 0; i + 1 < path.size(); ++i) {
+        CHECK(expectedEdges.count({path[i], path[i + 1]}) > 0);
+    }
+}
+
+
+// Queries cancelled as they reach each monoid, returns how many were cancelled rather than finished early
+unsigned int checkMonoidCancellation(const TestGraph<NUM_MONOIDS>& testGraph, std::mt19937& random) {
+    auto multicostArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(cancellingProps());
+    StaticMulticostGraph graph;
+    addEdges<NUM_MONOIDS>(graph, *multicostArray, testGraph.edges);
+
+    IteratedDijkstraPropagation pathfind;
+    unsigned int numCancelled = 0;
+
+    for (unsigned int q = 0; q < NUM_QUERIES; ++q) {
+        uint32_t start = random() % testGraph.numNodes;
+        uint32_t end = random() % testGraph.numNodes;
+        if (start == end) continue;
+
+        for (unsigned int k = 0; k < NUM_MONOIDS; ++k) {
+            QueryProgress edgesProgress;
+            QueryProgress pathProgress;
+            std::vector<uint32_t> path;
+
+            cancelMonoid = k;
+            cancelFlag = false;
+            QueryCancellation edgesCancellation(cancelFlag);
+            std::vector<uint32_t> optimalEdges = pathfind.getOptimalEdges(graph, multicostArray, start, end, edgesCancellation, edgesProgress);
+
+            cancelFlag = false;
+            QueryCancellation pathCancellation(cancelFlag);
+            pathfind.getOptimalPath(graph, multicostArray, start, end, path, pathCancellation, pathProgress);
+
+            cancelMonoid = NUM_MONOIDS;
+
+            // The subgraph collapsed to a single path before monoid k, which was then skipped
+            if (edgesProgress.isComplete) {
+                CHECK(edgesProgress.numMonoidsSkipped >= NUM_MONOIDS - k);
+                CHECK(pathProgress.isComplete);
+                continue;
+            }
+
+            CHECK(edgesProgress.numMonoidsOptimal == k);
+            CHECK(pathProgress.numMonoidsOptimal == k);
+            checkCancelledQuery(testGraph.edges, start, end, optimalEdges, path, edgesProgress);
+            checkCancelledQuery(testGraph.edges, start, end, optimalEdges, path, pathProgress);
+            numCancelled++;
+        }
+    }
+
+    return numCancelled;
+}
+
+
+// Deadlines that pass before and during a query on a large grid
+void checkDeadlineCancellation(std::mt19937& random) {
+    uint32_t side = 200;
+    std::vector<TestEdge<NUM_MONOIDS>> edges = gridEdges<NUM_MONOIDS>(side, side, 1, random);
+
+    auto multicostArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(additiveProps<NUM_MONOIDS>(false));
+    StaticMulticostGraph graph;
+    addEdges<NUM_MONOIDS>(graph, *multicostArray, edges);
+
+    IteratedDijkstraPropagation pathfind;
+    uint32_t start = 0;
+    uint32_t end = side * side - 1;
+
+    // Warm query, then the timed one the deadlines are set from
+    QueryCancellation noCancellation;
+    QueryProgress progress;
+    pathfind.getOptimalEdges(graph, multicostArray, start, end, noCancellation, progress);
+
+    auto begin = std::chrono::steady_clock::now();
+    pathfind.getOptimalEdges(graph, multicostArray, start, end, noCancellation, progress);
+    auto queryTime = std::chrono::steady_clock::now() - begin;
+    CHECK(progress.isComplete && progress.numMonoidsOptimal == NUM_MONOIDS);
+
+    // Already passed, nothing is optimal
+    QueryCancellation passedCancellation(std::chrono::steady_clock::now());
+    QueryProgress passedProgress;
+    std::vector<uint32_t> path;
+    pathfind.getOptimalPath(graph, multicostArray, start, end, path, passedCancellation, passedProgress);
+
+    CHECK(!passedProgress.isComplete);
+    CHECK(passedProgress.numMonoidsOptimal == 0);
+    CHECK(path.empty());
+
+    unsigned int numCancelled = 0;
+
+    for (unsigned int fraction = 1; fraction < 8; ++fraction) {
+        QueryCancellation edgesCancellation(std::chrono::steady_clock::now() + queryTime * fraction / 8);
+        QueryProgress edgesProgress;
+        std::vector<uint32_t> optimalEdges = pathfind.getOptimalEdges(graph, multicostArray, start, end, edgesCancellation, edgesProgress);
+
+        // The query can still beat its deadline on a faster run
+        if (edgesProgress.isComplete) continue;
+        numCancelled++;
+
+        // The path of the same monoids, cancelled by a flag raised once it reaches the next monoid
+        auto cancellingArray = std::make_shared<MonoMulticostArray<int, NUM_MONOIDS>>(cancellingProps());
+        StaticMulticostGraph cancellingGraph;
+        addEdges<NUM_MONOIDS>(cancellingGraph, *cancellingArray, edges);
+
+        cancelMonoid = edgesProgress.numMonoidsOptimal;
+        cancelFlag = false;
+        QueryCancellation pathCancellation(cancelFlag);
+        QueryProgress pathProgress;
+        pathfind.getOptimalPath(cancellingGraph, cancellingArray, start, end, path, pathCancellation, pathProgress);
+        cancelMonoid = NUM_MONOIDS;
+
+        CHECK(pathProgress.numMonoidsOptimal == edgesProgress.numMonoidsOptimal);
+        checkCancelledQuery(edges, start, end, optimalEdges, path, edgesProgress);
+    }
+
+    std::cout << numCancelled << " of 7 deadline queries cancelled" << std::endl;
+}
+
+
+int main() {
+    std::mt19937 random(26);
+
+    unsigned int numCancelled = 0;
+
+    // Unit costs on the first monoid keep every shortest grid path, so the subgraph seldom collapses early
+    for (TestGraph<NUM_MONOIDS>& testGraph : gridGraphs<NUM_MONOIDS>(NUM_GRIDS, 14, 1, random)) {
+        for (TestEdge<NUM_MONOIDS>& edge : testGraph.edges) edge.cost[0] = 1;
+        numCancelled += checkMonoidCancellation(testGraph, random);
+    }
+
+    CHECK(numCancelled > NUM_GRIDS * NUM_QUERIES);
+    std::cout << numCancelled << " queries cancelled after a monoid" << std::endl;
+
+    checkDeadlineCancellation(random);
+
+    return testResult();
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+// Moves and costs of TerrainGridState on random maps
+// 4, 8 and 16 connected states must reach exactly the moves whose destination and crossed
+// cells are free: both side cells of a diagonal, the two cells passed by a knight move.
+// getMoveCost must match getMoveCosts over the whole next set, and both the euclidean length
+// times the mean terrain weight of the ends
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "../include/grid_map.hpp"
+#include "../include/terrain_grid_state.hpp"
+#include "test_support.hpp"
+
+
+constexpr unsigned int NUM_MAPS = 30;
+
+
+bool isFree(const GridMap& map, int x, int y) {
+    return x >= 0 && y >= 0 && x < map.getWidth() && y < map.getHeight() && !map.isObstacle(x, y);
+}
+
+
+// Offsets of the moves a state at (x, y) may take, cells crossed written out move by move
+std::set<std::pair<int, int>> expectedMoves(const GridMap& map, int x, int y, GridConnectivity connectivity) {
+    std::set<std::pair<int, int>> moves;
+    if (!isFree(map, x, y)) return moves;
+
+    for (int dy = -2; dy <= 2; ++dy) {
+        for (int dx = -2; dx <= 2; ++dx) {
+            int adx = std::abs(dx);
+            int ady = std::abs(dy);
+            if (!isFree(map, x + dx, y + dy)) continue;
+
+            bool isOrthogonal = adx + ady == 1;
+            bool isDiagonal = adx == 1 && ady == 1;
+            bool isKnight = adx + ady == 3 && adx > 0 && ady > 0;
+
+            if (isOrthogonal) {
+                moves.insert({dx, dy});
+            } else if (isDiagonal && connectivity != GridConnectivity::FOUR) {
+                if (isFree(map, x + dx, y) && isFree(map, x, y + dy)) moves.insert({dx, dy});
+            } else if (isKnight && connectivity == GridConnectivity::SIXTEEN) {
+                // The first step goes along the long axis, the second crosses diagonally
+                int sx = dx / adx;
+                int sy = dy / ady;
+                bool isCrossedFree = adx == 2 ?
+                    isFree(map, x + sx, y) && isFree(map, x + sx, y + dy) :
+                    isFree(map, x, y + sy) && isFree(map, x + dx, y + sy);
+                if (isCrossedFree) moves.insert({dx, dy});
+            }
+        }
+    }
+
+    return moves;
+}
+
+
+void checkCosts(const GridMap& map, TerrainGridState& state, const std::vector<TerrainGridState>& nextStates) {
+    std::vector<int> costs(nextStates.size());
+    state.getMoveCosts(nextStates.data(), nextStates.size(), costs.data());
+
+    float fromWeight = map.getTerrainWeight(map.cellIndex(state.x, state.y));
+
+    for (unsigned int i = 0; i < nextStates.size(); ++i) {
+        CHECK(state.getMoveCost(nextStates[i]) == costs[i]);
+
+        int dx = nextStates[i].x - state.x;
+        int dy = nextStates[i].y - state.y;
+        float toWeight = map.getTerrainWeight(map.cellIndex(nextStates[i].x, nextStates[i].y));
+        double expected = std::sqrt(static_cast<double>(dx * dx + dy * dy)) * (fromWeight + toWeight) / 2 * TerrainGridState::COST_SCALE;
+
+        // Float rounding may land on the other side of a half unit
+        CHECK(std::abs(costs[i] - expected) <= 1.0);
+    }
+}
+
+
+void checkMap(const GridMap& map, GridConnectivity connectivity) {
+    for (int y = 0; y < map.getHeight(); ++y) {
+        for (int x = 0; x < map.getWidth(); ++x) {
+            TerrainGridState state(map, x, y, connectivity);
+            std::vector<TerrainGridState> nextStates = state.getNextStates();
+
+            std::set<std::pair<int, int>> moves;
+            for (const TerrainGridState& nextState : nextStates) moves.insert({nextState.x - x, nextState.y - y});
+
+            CHECK(moves.size() == nextStates.size());
+            CHECK(moves == expectedMoves(map, x, y, connectivity));
+
+            checkCosts(map, state, nextStates);
+        }
+    }
+}
+
+
+// One obstacle east of the center of a free 5x5 map
+void checkSingleObstacle() {
+    GridMap map(5, 5);
+    map.setObstacle(3, 2, true);
+
+    TerrainGridState eight(map, 2, 2, GridConnectivity::EIGHT);
+    std::set<std::pair<int, int>> eightMoves;
+    for (const TerrainGridState& nextState : eight.getNextStates()) eightMoves.insert({nextState.x - 2, nextState.y - 2});
+
+    // East and both diagonals around it are cut
+    CHECK(eightMoves == (std::set<std::pair<int, int>>{{0, -1}, {0, 1}, {-1, 0}, {-1, -1}, {-1, 1}}));
+
+    TerrainGridState sixteen(map, 2, 2, GridConnectivity::SIXTEEN);
+    std::set<std::pair<int, int>> sixteenMoves;
+    for (const TerrainGridState& nextState : sixteen.getNextStates()) sixteenMoves.insert({nextState.x - 2, nextState.y - 2});
+
+    // Knight moves two cells east pass the obstacle, the others only pass free cells
+    for (auto move : eightMoves) CHECK(sixteenMoves.count(move) > 0);
+    CHECK(sixteenMoves.count({2, -1}) == 0 && sixteenMoves.count({2, 1}) == 0);
+    CHECK(sixteenMoves.count({1, -2}) > 0 && sixteenMoves.count({1, 2}) > 0);
+    CHECK(sixteenMoves.size() == eightMoves.size() + 6);
+
+    // Unit weights give the scaled lengths
+    TerrainGridState north(map, 2, 1, GridConnectivity::SIXTEEN);
+    TerrainGridState diagonal(map, 1, 1, GridConnectivity::SIXTEEN);
+    TerrainGridState knight(map, 1, 0, GridConnectivity::SIXTEEN);
+    CHECK(sixteen.getMoveCost(north) == 1000);
+    CHECK(sixteen.getMoveCost(diagonal) == 1414);
+    CHECK(sixteen.getMoveCost(knight) == 2236);
+}
+
+
+int main() {
+    std::mt19937 random(44);
+
+    checkSingleObstacle();
+
+    for (unsigned int m = 0; m < NUM_MAPS; ++m) {
+        int width = 1 + random() % 14;
+        int height = 1 + random() % 14;
+
+        GridMap map(width, height);
+        for (int i = 0; i < width * height / 3; ++i) map.setObstacle(random() % width, random() % height, true);
+        for (int i = 0; i < width * height / 2; ++i) map.setTerrainWeight(random() % width, random() % height, 0.5f + (random() % 8) * 0.25f);
+
+        for (GridConnectivity connectivity : {GridConnectivity::FOUR, GridConnectivity::EIGHT, GridConnectivity::SIXTEEN}) {
+            checkMap(map, connectivity);
+        }
+    }
+
+    return testResult();
+}
\ No newline at end of file
@@ -0,0 +1,264 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+#include "../include/iterated_dijkstra_propagation.hpp"
+#include "../include/multicost.hpp"
+#include "../include/multicost_array.hpp"
+#include "../include/multicost_graph.hpp"
+#include "../include/multicost_pathfind.hpp"
+
+
+// Failed checks are reported and counted, main returns testResult()
+inline unsigned int& numFailedChecks() {
+    static unsigned int numFailed = 0;
+    return numFailed;
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << std::endl; \
+            numFailedChecks()++; \
+        } \
+    } while (0)
+
+inline int testResult() {
+    if (numFailedChecks() > 0) {
+        std::cerr << numFailedChecks() << " checks failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+
+
+template<unsigned int SIZE>
+struct TestEdge {
+    uint32_t frNode;
+    uint32_t toNode;
+    std::array<int, SIZE> cost;
+};
+
+
+// Directed edges between distinct nodes with costs in [0, maxCost], at most one edge per node pair
+template<unsigned int SIZE>
+std::vector<TestEdge<SIZE>> randomEdges(uint32_t numNodes, unsigned int numEdges, int maxCost, std::mt19937& random) {
+    std::vector<TestEdge<SIZE>> edges;
+    std::set<std::pair<uint32_t, uint32_t>> pairs;
+
+    while (edges.size() < numEdges && pairs.size() < static_cast<size_t>(numNodes) * (numNodes - 1)) {
+        uint32_t frNode = random() % numNodes;
+        uint32_t toNode = random() % numNodes;
+        if (frNode == toNode || !pairs.insert({frNode, toNode}).second) continue;
+
+        TestEdge<SIZE> edge = {frNode, toNode, {}};
+        for (unsigned int k = 0; k < SIZE; ++k) edge.cost[k] = random() % (maxCost + 1);
+        edges.push_back(edge);
+    }
+
+    return edges;
+}
+
+
+// 4-connected grid with both directions of every move, node y * width + x, costs in [1, 1 + maxExtraCost]
+template<unsigned int SIZE>
+std::vector<TestEdge<SIZE>> gridEdges(uint32_t width, uint32_t height, int maxExtraCost, std::mt19937& random) {
+    std::vector<TestEdge<SIZE>> edges;
+
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint32_t node = y * width + x;
+            std::vector<uint32_t> neighbors;
+            if (x + 1 < width) neighbors.push_back(node + 1);
+            if (y + 1 < height) neighbors.push_back(node + width);
+
+            for (uint32_t neighbor : neighbors) {
+                TestEdge<SIZE> edge = {node, neighbor, {}};
+                for (unsigned int k = 0; k < SIZE; ++k) edge.cost[k] = 1 + random() % (maxExtraCost + 1);
+                edges.push_back(edge);
+
+                std::swap(edge.frNode, edge.toNode);
+                edges.push_back(edge);
+            }
+        }
+    }
+
+    return edges;
+}
+
+
+// Nodes and edges of a generated test graph
+template<unsigned int SIZE>
+struct TestGraph {
+    uint32_t numNodes;
+    std::vector<TestEdge<SIZE>> edges;
+};
+
+
+// numGraphs randomEdges graphs of 5 to maxNodes nodes with 1 to 4 edges per node
+template<unsigned int SIZE>
+std::vector<TestGraph<SIZE>> randomGraphs(unsigned int numGraphs, uint32_t maxNodes, int maxCost, std::mt19937& random) {
+    std::vector<TestGraph<SIZE>> graphs;
+
+    for (unsigned int g = 0; g < numGraphs; ++g) {
+        uint32_t numNodes = 5 + random() % (maxNodes - 4);
+        unsigned int numEdges = numNodes * (1 + random() % 4);
+        graphs.push_back({numNodes, randomEdges<SIZE>(numNodes, numEdges, maxCost, random)});
+    }
+
+    return graphs;
+}
+
+
+// numGraphs gridEdges grids with sides of 2 to maxSide nodes
+template<unsigned int SIZE>
+std::vector<TestGraph<SIZE>> gridGraphs(unsigned int numGraphs, uint32_t maxSide, int maxExtraCost, std::mt19937& random) {
+    std::vector<TestGraph<SIZE>> graphs;
+
+    for (unsigned int g = 0; g < numGraphs; ++g) {
+        uint32_t width = 2 + random() % (maxSide - 1);
+        uint32_t height = 2 + random() % (maxSide - 1);
+        graphs.push_back({width * height, gridEdges<SIZE>(width, height, maxExtraCost, random)});
+    }
+
+    return graphs;
+}
+
+
+// Optimal edges given as node pairs by IMulticostPathfind::getOptimalEdges
+inline std::set<std::pair<uint32_t, uint32_t>> edgePairs(const std::vector<uint32_t>& optimalEdges) {
+    std::set<std::pair<uint32_t, uint32_t>> pairs;
+    for (unsigned int i = 0; i + 1 < optimalEdges.size(); i += 2) pairs.insert({optimalEdges[i], optimalEdges[i + 1]});
+    return pairs;
+}
+
+
+// SIZE monoids of int addition ordered by value, all of them set as additive
+template<unsigned int SIZE>
+MonoMulticostProps<int, SIZE> additiveProps(bool isLexicographic) {
+    std::array<int, SIZE> identity;
+    std::array<std::function<int(int a, int b)>, SIZE> compares;
+    std::array<std::function<int(int a, int b)>, SIZE> ops;
+    std::array<bool, SIZE> additive;
+
+    for (unsigned int k = 0; k < SIZE; ++k) {
+        identity[k] = 0;
+        compares[k] = [](int a, int b) { return a - b; };
+        ops[k] = [](int a, int b) { return a + b; };
+        additive[k] = true;
+    }
+
+    return MonoMulticostProps<int, SIZE>(identity, compares, ops, isLexicographic, additive);
+}
+
+
+template<unsigned int SIZE>
+void addEdges(StaticMulticostGraph& graph, MonoMulticostArray<int, SIZE>& multicostArray, const std::vector<TestEdge<SIZE>>& edges) {
+    for (const TestEdge<SIZE>& edge : edges) {
+        std::array<int, SIZE> cost = edge.cost;
+        graph.addEdge(edge.frNode, edge.toNode, multicostArray.make_multicost(std::move(cost)));
+    }
+}
+
+
+// Cost of every edge by its node pair
+template<unsigned int SIZE>
+std::map<std::pair<uint32_t, uint32_t>, std::array<int, SIZE>> edgeCosts(const std::vector<TestEdge<SIZE>>& edges) {
+    std::map<std::pair<uint32_t, uint32_t>, std::array<int, SIZE>> costs;
+    for (const TestEdge<SIZE>& edge : edges) costs[{edge.frNode, edge.toNode}] = edge.cost;
+    return costs;
+}
+
+
+// Sums the costs along path, false when two consecutive nodes are not joined by an edge
+template<unsigned int SIZE>
+bool pathCost(const std::map<std::pair<uint32_t, uint32_t>, std::array<int, SIZE>>& costs, const std::vector<uint32_t>& path, std::array<int, SIZE>& cost) {
+    cost.fill(0);
+    for (unsigned int i = 0; i + 1 < path.size(); ++i) {
+        auto edge = costs.find({path[i], path[i + 1]});
+        if (edge == costs.end()) return false;
+        for (unsigned int k = 0; k < SIZE; ++k) cost[k] += edge->second[k];
+    }
+    return true;
+}
+
+// Path weight composed by the ops of multicostArray, nullptr when two consecutive nodes are not joined by an edge
+inline std::unique_ptr<MulticostID> pathWeight(IMulticostGraph& graph, IMulticostArray& multicostArray, const std::vector<uint32_t>& path) {
+    std::unique_ptr<MulticostID> weight = multicostArray.identity();
+
+    for (unsigned int i = 0; i + 1 < path.size(); ++i) {
+        std::vector<MulticostEdge>& nextEdges = graph.getNextEdges(path[i], IMulticostGraph::ALL_MONOIDS);
+        auto edge = std::find_if(nextEdges.begin(), nextEdges.end(), [&](const MulticostEdge& e) { return e.nodeId == path[i + 1]; });
+        if (edge == nextEdges.end()) return nullptr;
+
+        weight = multicostArray.op(weight, graph.getEdgeCost(edge->edgeCostId));
+    }
+
+    return weight;
+}
+
+
+// Runs the query on pathfind and on a plain IteratedDijkstraPropagation, both must find the same
+// optimal edges and a path of the same weight made of optimal edges. True when end is reachable
+inline bool checkAgainstIdp(IMulticostPathfind& pathfind, IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t start, uint32_t end) {
+    IteratedDijkstraPropagation reference;
+
+    std::set<std::pair<uint32_t, uint32_t>> expectedEdges = edgePairs(reference.getOptimalEdges(graph, multicostArray, start, end));
+    CHECK(edgePairs(pathfind.getOptimalEdges(graph, multicostArray, start, end)) == expectedEdges);
+
+    std::vector<uint32_t> expectedPath = reference.getOptimalPath(graph, multicostArray, start, end);
+    std::vector<uint32_t> path = pathfind.getOptimalPath(graph, multicostArray, start, end);
+
+    CHECK(path.empty() == expectedPath.empty());
+    if (path.empty() || expectedPath.empty()) return false;
+
+    CHECK(path.front() == start && path.back() == end);
+
+    // Paths can differ among ties, every one of them is made of optimal edges
+    for (unsigned int i = 0; i + 1 < path.size(); ++i) {
+        CHECK(expectedEdges.count({path[i], path[i + 1]}) > 0);
+    }
+
+    std::unique_ptr<MulticostID> expectedWeight = pathWeight(graph, *multicostArray, expectedPath);
+    std::unique_ptr<MulticostID> weight = pathWeight(graph, *multicostArray, path);
+    CHECK(expectedWeight && weight);
+    if (expectedWeight && weight) CHECK(multicostArray->compare(weight, expectedWeight) == 0);
+
+    return true;
+}
+
+
+// numQueries checkAgainstIdp queries between random distinct nodes, returns how many were reachable
+inline unsigned int compareRandomQueries(IMulticostPathfind& pathfind, IMulticostGraph& graph, std::shared_ptr<IMulticostArray> multicostArray, uint32_t numNodes, unsigned int numQueries, std::mt19937& random) {
+    unsigned int numReachable = 0;
+
+    for (unsigned int q = 0; q < numQueries; ++q) {
+        uint32_t start = random() % numNodes;
+        uint32_t end = random() % numNodes;
+        if (start == end) continue;
+
+        if (checkAgainstIdp(pathfind, graph, multicostArray, start, end)) numReachable++;
+    }
+
+    return numReachable;
+}
+
+
+// Guards against generators that never connect their queries
+inline void checkNumReachable(unsigned int numReachable, unsigned int minReachable) {
+    CHECK(numReachable > minReachable);
+    std::cout << numReachable << " reachable queries compared" << std::endl;
+}
+
+#endif
\ No newline at end of file
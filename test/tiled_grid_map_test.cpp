@@ -0,0 +1,94 @@
+// TiledGridMap paging against the GridMap it was written from
+// Random reads must see the cells of the map while chunks are evicted, prefetched chunks must
+// keep flowing once the prefetch share is full, resident and prefetched chunks together must
+// stay within the budget, and grids with more than 2^32 cells must be rejected
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/grid_map.hpp"
+#include "../include/tiled_grid_map.hpp"
+#include "test_support.hpp"
+
+
+constexpr int CHUNK_SIDE = 16;
+constexpr unsigned int MAX_RESIDENT_CHUNKS = 8;
+
+
+void checkRandomReads(TiledGridMap& tiled, const GridMap& map, std::mt19937& random) {
+    for (int i = 0; i < 20000; ++i) {
+        int x = static_cast<int>(random() % (map.getWidth() + 2)) - 1;
+        int y = static_cast<int>(random() % (map.getHeight() + 2)) - 1;
+
+        bool isInside = x >= 0 && y >= 0 && x < map.getWidth() && y < map.getHeight();
+        CHECK(tiled.isObstacle(x, y) == (!isInside || map.isObstacle(x, y)));
+        CHECK(tiled.getNumResidentChunks() + tiled.getNumReadyChunks() <= MAX_RESIDENT_CHUNKS);
+    }
+
+    CHECK(tiled.getStats().numEvictions > 0);
+}
+
+
+void checkPrefetch(TiledGridMap& tiled, const GridMap& map) {
+    unsigned int numChunksX = (map.getWidth() + CHUNK_SIDE - 1) / CHUNK_SIDE;
+    unsigned int numChunksY = (map.getHeight() + CHUNK_SIDE - 1) / CHUNK_SIDE;
+
+    // Every round requests more chunks than the prefetch share holds, the newest ones must be ready
+    for (unsigned int round = 0; round < 3; ++round) {
+        // The chunks in use all come from the last column, which is never prefetched
+        for (unsigned int cy = 0; cy < numChunksY; ++cy) tiled.isObstacle((numChunksX - 1) * CHUNK_SIDE, cy * CHUNK_SIDE);
+
+        std::vector<std::pair<int, int>> cells;
+        for (unsigned int cy = 0; cy < numChunksY; ++cy) {
+            int x = ((round * 3 + cy) % (numChunksX - 1)) * CHUNK_SIDE;
+            cells.push_back({x, static_cast<int>(cy) * CHUNK_SIDE});
+        }
+
+        for (auto& [x, y] : cells) tiled.prefetch(x, y);
+        tiled.waitForPrefetches();
+
+        CHECK(tiled.getNumReadyChunks() > 0);
+        CHECK(tiled.getNumResidentChunks() + tiled.getNumReadyChunks() <= MAX_RESIDENT_CHUNKS);
+
+        unsigned int numHits = tiled.getStats().numPrefetchHits;
+        auto& [x, y] = cells.back();
+        CHECK(tiled.isObstacle(x, y) == map.isObstacle(x, y));
+        CHECK(tiled.getStats().numPrefetchHits == numHits + 1);
+    }
+}
+
+
+void checkTooManyCells() {
+    // 65537 x 65536 cells, one more row of ids than uint32_t holds
+    uint32_t header[4] = {0x31474D54, 65537, 65536, 256};
+    std::ofstream file("tiled_grid_map_test_large.tmg", std::ios::binary);
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.close();
+
+    TiledGridMap tiled;
+    std::cerr << "expected error:" << std::endl;
+    CHECK(!tiled.open("tiled_grid_map_test_large.tmg", MAX_RESIDENT_CHUNKS));
+}
+
+
+int main() {
+    std::mt19937 random(46);
+
+    GridMap map(200, 150);
+    for (int i = 0; i < 200 * 150 / 4; ++i) map.setObstacle(random() % 200, random() % 150, true);
+
+    CHECK(TiledGridMap::writeTiles("tiled_grid_map_test.tmg", map, CHUNK_SIDE));
+
+    TiledGridMap tiled;
+    CHECK(tiled.open("tiled_grid_map_test.tmg", MAX_RESIDENT_CHUNKS));
+    CHECK(tiled.getWidth() == 200 && tiled.getHeight() == 150);
+
+    checkRandomReads(tiled, map, random);
+    checkPrefetch(tiled, map);
+    checkRandomReads(tiled, map, random);
+    checkTooManyCells();
+
+    return testResult();
+}
@@ -0,0 +1,153 @@
+// VoxelState moves and VoxelMap obstacle counts against a brute force recount on a dense grid
+// A grid whose sides are not multiples of the brick side gets obstacles set and cleared around
+// the brick boundaries, then every voxel must list exactly the free moves of its connectivity
+// whose boxes are free, and count the obstacles among its six neighbors
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../include/voxel_map.hpp"
+#include "../include/voxel_state.hpp"
+#include "test_support.hpp"
+
+
+constexpr int WIDTH = 19;
+constexpr int HEIGHT = 13;
+constexpr int DEPTH = 17;
+
+
+struct DenseVoxels {
+    std::vector<uint8_t> obstacles = std::vector<uint8_t>(WIDTH * HEIGHT * DEPTH, 0);
+
+    bool isInside(int x, int y, int z) const {
+        return x >= 0 && y >= 0 && z >= 0 && x < WIDTH && y < HEIGHT && z < DEPTH;
+    }
+
+    bool isFree(int x, int y, int z) const {
+        return isInside(x, y, z) && !obstacles[(z * HEIGHT + y) * WIDTH + x];
+    }
+
+    int countObstacles(int x, int y, int z) const {
+        int offsets[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+        int count = 0;
+        for (auto& offset : offsets) {
+            int nx = x + offset[0];
+            int ny = y + offset[1];
+            int nz = z + offset[2];
+            if (isInside(nx, ny, nz) && !isFree(nx, ny, nz)) count++;
+        }
+        return count;
+    }
+
+    // Moves whose whole box is free, as voxel ids
+    std::vector<uint32_t> moves(const VoxelMap& map, int x, int y, int z, VoxelConnectivity connectivity) const {
+        std::vector<uint32_t> result;
+        if (!isFree(x, y, z)) return result;
+
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int numAxes = (dx != 0) + (dy != 0) + (dz != 0);
+                    if (numAxes == 0 || (connectivity == VoxelConnectivity::SIX && numAxes > 1)) continue;
+
+                    bool isBoxFree = true;
+                    for (int corner = 1; corner < 8; ++corner) {
+                        int bx = (corner & 1) ? dx : 0;
+                        int by = (corner & 2) ? dy : 0;
+                        int bz = (corner & 4) ? dz : 0;
+                        if (!isFree(x + bx, y + by, z + bz)) isBoxFree = false;
+                    }
+
+                    if (isBoxFree) result.push_back(map.voxelIndex(x + dx, y + dy, z + dz));
+                }
+            }
+        }
+
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+};
+
+
+void setObstacle(VoxelMap& map, DenseVoxels& dense, int x, int y, int z, bool isObstacle) {
+    map.setObstacle(x, y, z, isObstacle);
+    dense.obstacles[(z * HEIGHT + y) * WIDTH + x] = isObstacle;
+}
+
+
+// Coordinates around the brick boundaries and the grid sides
+int nearBoundary(int side, std::mt19937& random) {
+    int boundary = (random() % (side / VoxelMap::BRICK_SIDE + 1)) * VoxelMap::BRICK_SIDE;
+    int coordinate = boundary + static_cast<int>(random() % 4) - 2;
+    return std::min(std::max(coordinate, 0), side - 1);
+}
+
+
+void checkVoxels(const VoxelMap& map, const DenseVoxels& dense, VoxelConnectivity connectivity) {
+    for (int z = 0; z < DEPTH; ++z) {
+        for (int y = 0; y < HEIGHT; ++y) {
+            for (int x = 0; x < WIDTH; ++x) {
+                VoxelState state(map, x, y, z, connectivity);
+
+                CHECK(map.isObstacle(x, y, z) == !dense.isFree(x, y, z));
+                CHECK(state.numberOfNearbyObstacles() == dense.countObstacles(x, y, z));
+
+                VoxelState buffer[VoxelState::MAX_NEXT_STATES];
+                unsigned int numNextStates = state.getNextStates(buffer);
+                std::vector<VoxelState> nextStates = state.getNextStates();
+                CHECK(nextStates.size() == numNextStates);
+
+                std::vector<uint32_t> ids;
+                for (unsigned int i = 0; i < numNextStates; ++i) {
+                    ids.push_back(buffer[i].getUniqueId());
+
+                    int numAxes = (buffer[i].x != x) + (buffer[i].y != y) + (buffer[i].z != z);
+                    int expectedCost = numAxes == 1 ? 1000 : (numAxes == 2 ? 1414 : 1732);
+                    CHECK(state.getMoveCost(buffer[i]) == expectedCost);
+                }
+                std::sort(ids.begin(), ids.end());
+
+                CHECK(ids == dense.moves(map, x, y, z, connectivity));
+            }
+        }
+    }
+}
+
+
+int main() {
+    std::mt19937 random(47);
+
+    VoxelMap map(WIDTH, HEIGHT, DEPTH);
+    DenseVoxels dense;
+
+    for (int i = 0; i < 900; ++i) {
+        int x = nearBoundary(WIDTH, random);
+        int y = nearBoundary(HEIGHT, random);
+        int z = nearBoundary(DEPTH, random);
+        setObstacle(map, dense, x, y, z, true);
+    }
+    for (int i = 0; i < 400; ++i) {
+        setObstacle(map, dense, random() % WIDTH, random() % HEIGHT, random() % DEPTH, true);
+    }
+
+    // Clearing patches the counts back, also in bricks that keep no obstacle
+    for (int i = 0; i < 500; ++i) {
+        setObstacle(map, dense, nearBoundary(WIDTH, random), nearBoundary(HEIGHT, random), nearBoundary(DEPTH, random), false);
+    }
+
+    checkVoxels(map, dense, VoxelConnectivity::SIX);
+    checkVoxels(map, dense, VoxelConnectivity::TWENTY_SIX);
+
+    // An empty map keeps no bricks and every interior voxel has all its moves
+    VoxelMap emptyMap(WIDTH, HEIGHT, DEPTH);
+    VoxelState center(emptyMap, 8, 8, 8);
+    CHECK(emptyMap.getNumBricks() == 0);
+    CHECK(center.getNextStates().size() == 26);
+    CHECK(VoxelState(emptyMap, 8, 8, 8, VoxelConnectivity::SIX).getNextStates().size() == 6);
+    CHECK(VoxelState(emptyMap, 0, 0, 0).getNextStates().size() == 7);
+
+    return testResult();
+}